@@ -0,0 +1,30 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include "TStopwatch.h"
+
+#include "../interface/RunStats.h"
+
+#include <iomanip>
+#include <iostream>
+
+  //--------------------------------------------------------------------------
+  // report
+  // *
+  // *      The line every benchmark prints per timing, the real time of sw
+  // *      and the time per item in unit, scale converting seconds to it:
+  // *
+  // *          report("TemplateStore", sw, nToys, 1e6, "us/toy");
+  // *
+  // *      The time also goes to the RunStats report under what.
+  // *------------------------------------------------------------------------
+
+inline void report(const char* what, TStopwatch &sw, double items, double scale, const char* unit,
+                   int precision = 3) {
+  std::cout<<" - "<<std::setw(34)<<std::left<<what<<std::right<<std::fixed<<std::setprecision(3)
+           <<std::setw(10)<<sw.RealTime()<<" s  "<<std::setprecision(precision)
+           <<std::setw(10)<<scale*sw.RealTime()/items<<" "<<unit<<std::endl;
+  RunStats::instance().addTime(what, sw.RealTime());
+}
+
+#endif
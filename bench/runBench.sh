@@ -0,0 +1,192 @@
+#!/bin/bash
+#
+# Runs the benchmarks over the shipped samples (make bench, make and make
+# massfit first, or just make benchmark) and checks their output against the
+# golden files in bench/golden:
+#
+#      bench/runBench.sh [--bless] [--quick]
+#
+#  - MorphBench on three width pairs of samples/plotter_*.root, at the full
+#    binning and rebinned by 2 and 5; fails on any morphing mismatch
+#  - ClassifierBench over the keys of all plotter files
+#  - TemplateStoreBench
+#  - GofBench on plotter_1_5.root; fails if the KS distances differ from
+#    TH1::KolmogorovTest or the toy probabilities depend on the threads
+#  - the MLBWOProcessor pipeline (yields, KS, MassFit output with 4
+#    interpolations) on the plotter files; the yields and KS tables and a
+#    dump of the output histograms (bench/dumpHistos.C) are golden outputs,
+#    the same run streaming its input (-s) is checked against them, and so
+#    is the same interpolation as a job of a batch (-b, -J 2). A run with 3
+#    interpolations, which land on the anchors, has its own golden dump and
+#    has to write the anchor templates as the run with 4 does
+#  - FlatTemplateBench on the pipeline output and on the flat file a batch
+#    job wrote (-f); fails if a template does not come back bin for bin
+#  - bench/MassFitBench.C: fitAll() and do_toys() on 2012_combined_EACMLB.root,
+#    the "golden" lines are compared
+#
+# Every run writes its RunStats report (timers and counters) as JSON to
+# $BENCH_OUTPUT (bench/results by default), summary.csv lists the runs and
+# their status. --bless replaces the golden files with this run's output,
+# --quick runs fewer repetitions and toys. A golden file that is not there
+# is a failure: bless (and commit) it first, see bench/golden/README.
+
+cd "$(dirname "$0")/.." || exit 1
+top=$(pwd)
+out=${BENCH_OUTPUT:-$top/bench/results}
+golden=$top/bench/golden
+bless=0
+quick=0
+for arg in "$@"; do
+    case $arg in
+        --bless) bless=1 ;;
+        --quick) quick=1 ;;
+        *) echo "Usage: $0 [--bless] [--quick]"; exit 1 ;;
+    esac
+done
+
+for exe in bench/MorphBench bench/ClassifierBench bench/TemplateStoreBench bench/GofBench \
+           bench/FlatTemplateBench MLBWOProcessor; do
+    if [ ! -x $exe ]; then
+        echo "ERROR: no $exe, run make and make bench first"
+        exit 1
+    fi
+done
+
+mkdir -p "$out" "$golden"
+echo "name,status,report" > "$out/summary.csv"
+failures=0
+
+# record <name> <status> [report]
+record() {
+    echo "$1,$2,$3" >> "$out/summary.csv"
+    echo " - $1: $2"
+    if [ "$2" != "ok" ]; then failures=$((failures+1)); fi
+}
+
+# check <name> <output file>: against bench/golden/<name>
+check() {
+    if [ $bless -eq 1 ]; then
+        cp "$2" "$golden/$1"
+        record "golden $1" "ok"
+    elif [ ! -f "$golden/$1" ]; then
+        record "golden $1" "FAILED, no $golden/$1, run with --bless"
+    elif diff -u "$golden/$1" "$2" > "$out/$1.diff"; then
+        rm -f "$out/$1.diff"
+        record "golden $1" "ok"
+    else
+        record "golden $1" "FAILED, see $out/$1.diff"
+    fi
+}
+
+# run <name> <command...>: the command's report goes to $out/<name>.json
+run() {
+    local name=$1
+    shift
+    if RUNSTATS_REPORT="$out/$name.json" "$@" > "$out/$name.log" 2>&1; then
+        record "$name" "ok" "$name.json"
+    else
+        record "$name" "FAILED, see $out/$name.log" "$name.json"
+    fi
+}
+
+reps=20; keys=100; toys=1000000; mfToys=200; gofToys=2000
+if [ $quick -eq 1 ]; then reps=2; keys=10; toys=100000; mfToys=20; gofToys=200; fi
+
+for pair in "1_5 1.5 3_0 3.0" "1_5 1.5 7_5 7.5" "4_5 4.5 6_0 6.0"; do
+    set -- $pair
+    for rebin in 1 2 5; do
+        run "morph_$1_$3_rebin$rebin" bench/MorphBench -n $reps -b $rebin \
+            samples/plotter_$1.root $2 samples/plotter_$3.root $4
+    done
+done
+
+run classifier bench/ClassifierBench -n $keys samples/plotter_*.root
+run templatestore bench/TemplateStoreBench -n $toys
+run gof bench/GofBench -t $gofToys -j 4 samples/plotter_1_5.root
+
+# pipeline <name> <interpolations> <golden histos> [options]: the processor
+# writes ../2012_combined_EACMLB.root, so it runs two levels down in $out and
+# leaves the shipped file alone; the streaming run (-s) has to give the same
+# tables and histograms
+pipeline() {
+    local name=$1 interpolations=$2 histos=$3
+    shift 3
+    mkdir -p "$out/$name/run"
+    (cd "$out/$name/run" && echo y | RUNSTATS_REPORT="$out/$name.json" \
+        "$top/MLBWOProcessor" -q -r "$out/$name.json" "$@" 1.5 "$top/samples/plotter_1_5.root" \
+        3.0 "$top/samples/plotter_3_0.root" 4.5 "$top/samples/plotter_4_5.root" \
+        6.0 "$top/samples/plotter_6_0.root" 7.5 "$top/samples/plotter_7_5.root" $interpolations) \
+        > "$out/$name.log" 2>&1
+    if [ $? -eq 0 ]; then
+        record $name "ok" "$name.json"
+        sed -n '/Here is the LaTeX/,$p' "$out/$name.log" > "$out/${name}_tables.txt"
+        check pipeline_tables.txt "$out/${name}_tables.txt"
+        root -l -b -q "bench/dumpHistos.C(\"$out/$name/2012_combined_EACMLB.root\")" 2>&1 \
+            | grep -v '^$\|^Processing' > "$out/${name}_histos.txt"
+        check $histos "$out/${name}_histos.txt"
+    else
+        record $name "FAILED, see $out/$name.log" "$name.json"
+    fi
+}
+
+pipeline pipeline 4 pipeline_histos.txt
+run flat bench/FlatTemplateBench -n $reps "$out/pipeline/2012_combined_EACMLB.root"
+if [ $bless -eq 0 ]; then
+    pipeline pipeline_stream 4 pipeline_histos.txt -s -j 2
+fi
+
+# 3 interpolations fall on the anchors 3.0, 4.5 and 6.0: they are not
+# interpolated, and the anchors have to be written as they are, i.e. as by
+# the run with 4 interpolations, whose widths are between them
+pipeline pipeline_anchors 3 pipeline_anchors_histos.txt
+for run in pipeline pipeline_anchors; do
+    grep '^mlbwa__TTbar_\(3\.00\|4\.50\|6\.00\)_' "$out/${run}_histos.txt" > "$out/${run}_anchors.txt"
+done
+if [ ! -s "$out/pipeline_anchors.txt" ]; then
+    record "anchors" "FAILED, no anchor templates in $out/pipeline_histos.txt"
+elif diff -u "$out/pipeline_anchors.txt" "$out/pipeline_anchors_anchors.txt" > "$out/anchors.diff"; then
+    rm -f "$out/anchors.diff"
+    record "anchors" "ok"
+else
+    record "anchors" "FAILED, see $out/anchors.diff"
+fi
+
+# the same interpolation and the five plotter files on their own, as one batch
+# (-b) of jobs two at a time; the interpolation job has to give the same
+# histograms as the pipeline
+batch() {
+    local p=$top/samples/plotter
+    mkdir -p "$out/batch"
+    {
+        echo "job interp $out/batch/interp.root 1.5 ${p}_1_5.root 3.0 ${p}_3_0.root" \
+             "4.5 ${p}_4_5.root 6.0 ${p}_6_0.root 7.5 ${p}_7_5.root interpolate 4"
+        for w in 1_5 3_0 4_5 6_0 7_5; do
+            echo "job plotter_$w $out/batch/plotter_$w.root ${w/_/.} ${p}_$w.root gof $out/batch/gof_$w.csv" \
+                 "flat $out/batch/plotter_$w.flat"
+        done
+    } > "$out/batch/jobs.txt"
+    (cd "$out/batch" && "$top/MLBWOProcessor" -q -r "$out/batch.json" -J 2 -j 2 -b jobs.txt) \
+        > "$out/batch.log" 2>&1
+    if [ $? -eq 0 ]; then
+        record batch "ok" "batch.json"
+        root -l -b -q "bench/dumpHistos.C(\"$out/batch/interp.root\")" 2>&1 \
+            | grep -v '^$\|^Processing' > "$out/batch_histos.txt"
+        if [ $bless -eq 0 ]; then check pipeline_histos.txt "$out/batch_histos.txt"; fi
+        run flat_batch bench/FlatTemplateBench -n $reps "$out/batch/plotter_1_5.root" \
+            "$out/batch/plotter_1_5.flat"
+    else
+        record batch "FAILED, see $out/batch.log" "batch.json"
+    fi
+}
+
+batch
+
+run massfit root -l -b -q "bench/MassFitBench.C($mfToys, 2, \"$out/massfit.json\")"
+grep '^golden' "$out/massfit.log" > "$out/massfit_golden.txt"
+if [ $quick -eq 0 ]; then
+    check massfit_golden.txt "$out/massfit_golden.txt"
+fi
+
+echo
+echo "$failures failures, results in $out"
+[ $failures -eq 0 ]
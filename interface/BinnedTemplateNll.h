@@ -0,0 +1,121 @@
+#ifndef BINNEDTEMPLATENLL_H
+#define BINNEDTEMPLATENLL_H
+
+#include "Minuit2/FCNGradientBase.h"
+#include "Minuit2/FunctionMinimum.h"
+#include "Minuit2/MnHesse.h"
+#include "Minuit2/MnMigrad.h"
+#include "Minuit2/MnUserParameters.h"
+
+#include "RunStats.h"
+
+#include <cstdio>
+
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // BinnedTemplateNll
+  // *
+  // *      The binned Poisson likelihood of a signal and a background
+  // *      template fitted to the data of several channels at once, computed
+  // *      straight from flat arrays and minimised by Minuit2 with its
+  // *      analytic gradient. Per channel c, with n_b entries in bin b (N_c
+  // *      in total) and the signal and background bin probabilities s_b
+  // *      and b_b:
+  // *
+  // *          kRatio:   mu_b = N_c (r_c s_b + (1-r_c) b_b)   parameters r_c
+  // *          kYields:  mu_b = S_c s_b + B_c b_b             parameters S_c, B_c
+  // *
+  // *          NLL = sum_c sum_b ( mu_b - n_b + n_b log(n_b/mu_b) )
+  // *
+  // *      i.e. what RooFit minimises for the ratio%s and Nsig%s /
+  // *      nbrBackgroundEvents%s models, up to terms that depend neither on
+  // *      the parameters nor on the templates. The constant of the
+  // *      saturated model, sum_b (n_b log n_b - n_b) with 0 log 0 = 0, is
+  // *      kept, so the NLL is half the deviance and never negative, as the
+  // *      template scan expects of a fitted point. The parameters are
+  // *      laid out channel after channel (r_0, r_1, ... or S_0, B_0, S_1,
+  // *      B_1, ...).
+  // *
+  // *      Empty bins only enter through sum_b mu_b, which is known, so the
+  // *      bins with entries are packed into contiguous arrays and the loops
+  // *      over them are flat and branch free.
+  // *------------------------------------------------------------------------
+
+class BinnedTemplateNll : public ROOT::Minuit2::FCNGradientBase {
+  public:
+    enum Parameterization { kRatio = 0, kYields = 1 };
+
+    BinnedTemplateNll();
+
+    // channel c has the bins firstBin[c] .. firstBin[c+1]-1 of the arrays
+    void setChannels(const std::vector<int> &firstBin, int parameterization);
+
+    // bin probabilities of the templates, each normalised within a channel
+    void setShapes(const double *signal, const double *background);
+    void setSignal(const double *signal);
+    void setData(const double *counts);
+
+    int nChannels() const { return first_.size()-1; }
+    int nParameters() const { return (parameterization_ == kRatio ? 1 : 2)*nChannels(); }
+    double observed(int channel) const { return total_[channel]; }
+
+    double value(const double *par) const;
+    void gradient(const double *par, double *grad) const;
+
+    // the Minuit2 interface
+    double operator()(const std::vector<double> &par) const { return value(&par[0]); }
+    std::vector<double> Gradient(const std::vector<double> &par) const;
+    bool CheckGradient() const { return false; }
+    double Up() const { return 0.5; }
+
+    // migrad from par within [lower, upper], the fixed ones kept; par gets
+    // the minimum, returns false if Minuit2 did not find a valid one
+    bool minimize(std::vector<double> &par, const std::vector<double> &lower,
+                  const std::vector<double> &upper, const std::vector<bool> &fixed,
+                  double &minimum) const;
+
+  private:
+    void pack();
+
+    int parameterization_;
+    std::vector<int> first_;
+    std::vector<double> signal_, background_, counts_, total_;
+    std::vector<double> saturated_;        // per channel, sum_b (n_b log n_b - n_b)
+
+    // the bins with entries of every channel, packed
+    std::vector<int> packedFirst_;
+    std::vector<double> packedCounts_, packedSignal_, packedBackground_;
+};
+
+// migrad on fcn from par within [lower, upper], the fixed ones kept; par
+// gets the minimum and, if errors is given, hesse fills it. Returns false
+// if Minuit2 did not find a valid minimum.
+template <class FCN>
+bool migradMinimum(const FCN &fcn, std::vector<double> &par, const std::vector<double> &lower,
+                   const std::vector<double> &upper, const std::vector<bool> &fixed,
+                   double &minimum, std::vector<double> *errors = 0) {
+  ROOT::Minuit2::MnUserParameters start;
+  char name[20];
+  for(unsigned int k=0; k<par.size(); k++) {
+    sprintf(name, "p%u", k);
+    double step = 0.1*(upper[k]-lower[k]);
+    start.Add(name, par[k], (step > 0 ? step : 0.1), lower[k], upper[k]);
+    if(fixed[k]) start.Fix(k);
+  }
+
+  ROOT::Minuit2::MnMigrad migrad(fcn, start);
+  ROOT::Minuit2::FunctionMinimum result = migrad();
+  RUNSTATS_COUNT(kFcnCalls, result.NFcn());
+  if(errors && result.IsValid()) {
+    ROOT::Minuit2::MnHesse hesse;
+    hesse(fcn, result);
+  }
+
+  par = result.UserParameters().Params();
+  if(errors) *errors = result.UserParameters().Errors();
+  minimum = result.Fval();
+  return result.IsValid();
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef FLATTEMPLATEHISTO_H
+#define FLATTEMPLATEHISTO_H
+
+#include "TH1.h"
+#include "TH1F.h"
+#include "TString.h"
+
+#include "FlatTemplates.h"
+
+  //--------------------------------------------------------------------------
+  // FlatTemplateHisto
+  // *
+  // *      The ROOT side of FlatTemplates, which itself does without ROOT:
+  // *
+  // *          FlatTemplateWriter out;
+  // *          addFlatTemplate(out, "mlbwa__TTbar_1.50_EE", h);
+  // *          ...
+  // *          TH1F *back = flatTemplateHisto(*file.find("mlbwa__TTbar_1.50_EE"));
+  // *
+  // *      The edges, the contents and the sums of squared weights (if the
+  // *      histogram has them) are kept with under- and overflow, and the
+  // *      number of entries, so the histogram read back has the bins of the
+  // *      one written; its mean and RMS are those of the bins, as after
+  // *      TH1::ResetStats(). Equally spaced edges give back a fixed axis.
+  // *------------------------------------------------------------------------
+
+// adds histo to out under name; false if the name is not a template name
+// (see FlatTemplateWriter::splitName) or is already there
+bool addFlatTemplate(FlatTemplateWriter &out, const TString &name, const TH1 *histo);
+
+// a new TH1F, in no directory, named name (by default the template's name)
+TH1F *flatTemplateHisto(const FlatTemplate &t, const char *name = 0);
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef FLATTEMPLATES_H
+#define FLATTEMPLATES_H
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // FlatTemplateWriter, FlatTemplateFile
+  // *
+  // *      The MassFit templates (mlbwa__<Process>_<lep>, and for the
+  // *      signal mlbwa__<Process>_<width>_<lep>, the morphed widths
+  // *      included) in one flat binary file that is mmap'ed and read in
+  // *      place, without ROOT:
+  // *
+  // *          FlatTemplateWriter out;
+  // *          out.add("mlbwa__TTbar_1.50_EE", nb, edges, contents, sumw2, entries);
+  // *          out.write("2012_combined_EACMLB.flat");
+  // *
+  // *          FlatTemplateFile in;
+  // *          in.open("2012_combined_EACMLB.flat");
+  // *          const FlatTemplate *t = in.find("TTbar", "EE", 1.5);
+  // *          t->contents[1];     // the first bin, straight from the file
+  // *
+  // *      Layout, in the byte order of the writer, every block aligned to
+  // *      kFlatAlign bytes:
+  // *
+  // *          header  : FlatTemplateHeader
+  // *          index   : a FlatTemplateEntry per template, sorted by process,
+  // *                    channel and width
+  // *          strings : the names, processes and channels, NUL-terminated
+  // *          data    : per template nbins+1 edges, nbins+2 contents and
+  // *                    (if it has them) nbins+2 sums of squared weights,
+  // *                    doubles, under- and overflow first and last as TH1
+  // *                    keeps them
+  // *
+  // *      Templates without a width (data, backgrounds) have width -1.
+  // *      open() checks the magic, version, byte order and that every
+  // *      offset is inside the file, and refuses anything else.
+  // *      flatTemplateHisto() (FlatTemplateHisto.h) turns a template back
+  // *      into a TH1F.
+  // *------------------------------------------------------------------------
+
+static const uint32_t kFlatVersion   = 1;
+static const uint32_t kFlatByteOrder = 0x01020304;
+static const uint64_t kFlatAlign     = 64;
+
+// On disk, 64 bytes
+struct FlatTemplateHeader {
+  char     magic[8];                  // "MLBWFLAT"
+  uint32_t version;                   // kFlatVersion
+  uint32_t byteOrder;                 // kFlatByteOrder as the writer stored it
+  uint64_t count;                     // templates
+  uint64_t indexOffset;
+  uint64_t stringsOffset, stringsSize;
+  uint64_t dataOffset;
+  uint64_t fileSize;
+};
+
+// On disk, 64 bytes
+struct FlatTemplateEntry {
+  uint32_t name, process, channel;    // offsets into the strings
+  uint32_t nbins;
+  double   width;                     // -1 if none
+  double   entries;
+  uint64_t edges, contents, sumw2;    // file offsets, sumw2 0 if there are none
+  uint64_t reserved;
+};
+
+// A template of an open FlatTemplateFile; the pointers are into its mapping
+struct FlatTemplate {
+  const char   *name, *process, *channel;
+  double        width;
+  int           nbins;
+  double        entries;
+  const double *edges;                // nbins+1
+  const double *contents;             // nbins+2
+  const double *sumw2;                // nbins+2, or 0
+};
+
+class FlatTemplateWriter {
+  public:
+    FlatTemplateWriter();
+
+    // splits mlbwa__<Process>_[<width>_]<lep>; width is -1 if there is none
+    static bool splitName(const std::string &name, std::string &process,
+                          std::string &channel, double &width);
+
+    // copies the arrays (as in FlatTemplate, sumw2 may be 0); returns
+    // false if the name does not split or is already there
+    bool add(const std::string &name, int nbins, const double *edges,
+             const double *contents, const double *sumw2, double entries);
+
+    int size() const { return items_.size(); }
+
+    // writes everything to fileName, through a temporary file renamed at
+    // the end; returns the size of the file in bytes, or -1
+    long long write(const char *fileName) const;
+
+  private:
+    struct Item {
+      std::string name, process, channel;
+      double width, entries;
+      int nbins;
+      std::vector<double> edges, contents, sumw2;
+    };
+    std::vector<Item> items_;
+    std::unordered_map<std::string, int> lookup_;   // name -> position in items_
+};
+
+class FlatTemplateFile {
+  public:
+    FlatTemplateFile();
+    ~FlatTemplateFile();
+
+    // maps fileName read-only; false, with error() set, if it cannot be
+    // used. An open file is closed first
+    bool open(const char *fileName);
+    void close();
+
+    bool isOpen() const { return map_ != 0; }
+    const std::string &error() const { return error_; }
+    long long bytes() const { return mapSize_; }
+
+    int size() const { return templates_.size(); }
+    const FlatTemplate &at(int i) const { return templates_[i]; }
+
+    // 0 if there is no such template
+    const FlatTemplate *find(const char *name) const;
+    const FlatTemplate *find(const char *process, const char *channel, double width = -1) const;
+
+  private:
+    FlatTemplateFile(const FlatTemplateFile&);
+    FlatTemplateFile& operator=(const FlatTemplateFile&);
+
+    bool fail(const std::string &message);
+
+    void *map_;
+    size_t mapSize_;
+    std::string error_;
+    std::vector<FlatTemplate> templates_;           // in index order
+    std::unordered_map<std::string, int> names_;
+};
+
+#endif
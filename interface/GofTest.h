@@ -0,0 +1,86 @@
+#ifndef GOFTEST_H
+#define GOFTEST_H
+
+#include "TH1.h"
+
+#include <vector>
+
+class ThreadPool;
+
+// The outcome of GofTest::test(); probabilities are -1 if not available
+struct GofResult {
+  bool   ok;              // false if there was no MC or no data, or dropped MC
+  double observed;        // data entries
+  double expected;        // sum of the MC weights
+  double ks, ksProb;
+  double ad, adProb;
+  double chi2, chi2Prob;
+  int    ndf;
+  int    toys;            // 0 if the probabilities are asymptotic
+  int    dropped;         // MC histograms not added, their binning differed
+};
+
+  //--------------------------------------------------------------------------
+  // GofTest
+  // *
+  // *      Goodness of fit of a binned data histogram to the (weighted) sum
+  // *      of MC histograms, on plain arrays of the bin contents:
+  // *
+  // *          GofTest gof;
+  // *          gof.addExpected(mc1);
+  // *          gof.addExpected(mc2);          // summed bin by bin
+  // *          gof.setObserved(data);
+  // *          GofResult r = gof.test(2000, 4357);
+  // *
+  // *      The statistics compare shapes, the MC is normalised to the data:
+  // *       - KS, the largest distance between the cumulative distributions
+  // *       - AD, Anderson-Darling: N sum_i p_i (F_i - E_i)^2 / (E_i (1-E_i))
+  // *         over the bins with 0 < E_i < 1
+  // *       - chi2, Pearson with the MC statistical variance added, ndf the
+  // *         bins with MC content less one
+  // *
+  // *      Without toys the probabilities are asymptotic: KS from
+  // *      TMath::KolmogorovProb with the effective entries of data and MC
+  // *      ((sum w)^2 / sum w^2) combined, chi2 from TMath::Prob, none for
+  // *      AD. With toys every probability is the fraction (k+1)/(n+1) of
+  // *      data sets drawn from the MC shape (Poisson in every bin, mean N
+  // *      p_i) that fit at least as badly.
+  // *
+  // *      The toys are drawn in blocks, each with its own TRandom3 seeded
+  // *      from seed and the block, so the result does not depend on the
+  // *      threads: test() spreads the blocks over pool if given one, which
+  // *      must not be the pool test() itself runs on. Bins are 1..n, no
+  // *      under- or overflow, as in TH1::KolmogorovTest.
+  // *------------------------------------------------------------------------
+
+class GofTest {
+  public:
+    GofTest();
+
+    // forgets the MC and the data
+    void reset();
+
+    // a histogram with other bins than the first one is not added, and
+    // the test() after it is not ok
+    void addExpected(const TH1 *histo);
+    void setObserved(const TH1 *histo);
+    int nbins() const { return expected_.size(); }
+
+    GofResult test(int nToys = 0, UInt_t seed = 4357, ThreadPool *pool = 0) const;
+
+  private:
+    static const int kToyBlock = 256;
+
+    // the statistics of observed (nbins() contents) against the MC shape,
+    // which prepare() has set up
+    void statistics(const double *observed, double &ks, double &ad, double &chi2, int &ndf) const;
+    void prepare() const;
+
+    std::vector<double> expected_, variance_, observed_;
+    int dropped_;
+
+    // the MC shape: fractions, cumulative fractions and variance of the fractions
+    mutable std::vector<double> p_, cdf_, pVariance_;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef HISTOACCUMULATOR_H
+#define HISTOACCUMULATOR_H
+
+#include "TH1.h"
+#include "TString.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // HistoAccumulator
+  // *
+  // *      Collects the histograms of an output file in memory, summing
+  // *      the ones that end up with the same name (but for adoptUnique()),
+  // *      and writes each of them exactly once at the end:
+  // *
+  // *          HistoAccumulator out;
+  // *          out.add("mlbwa__TTbar_1.50_EE", h1);   // clone of h1
+  // *          out.add("mlbwa__TTbar_1.50_EE", h2);   // h2 added to it
+  // *          out.write("2012_combined_EACMLB.root", 1);
+  // *
+  // *      Names are looked up in a hash map; the histograms are written in
+  // *      the order their names were first added.
+  // *------------------------------------------------------------------------
+
+class HistoAccumulator {
+  public:
+    HistoAccumulator();
+    ~HistoAccumulator();
+
+    // adds a copy of histo under name, or sums it into the histogram
+    // already there; returns true if it was summed
+    bool add(const TString &name, const TH1 *histo);
+
+    // as add(), but takes ownership of histo instead of copying it
+    bool adopt(const TString &name, TH1 *histo);
+
+    // takes ownership of histo, which must be the only one of its name (a
+    // template that is not summed over inputs, e.g. a width anchor or a
+    // morphed width); returns false, and deletes histo, if the name is
+    // taken already
+    bool adoptUnique(const TString &name, TH1 *histo);
+
+    // the histogram collected under name, 0 if there is none
+    TH1 *get(const TString &name) const;
+
+    int size() const { return histos_.size(); }
+
+    // writes everything to fileName (RECREATE) with the given compression
+    // setting; returns the size of the file in bytes, or -1
+    Long64_t write(const char *fileName, int compression);
+
+    // the same histograms as a flat template file (see FlatTemplates);
+    // returns its size in bytes, or -1
+    Long64_t writeFlat(const char *fileName) const;
+
+  private:
+    HistoAccumulator(const HistoAccumulator&);
+    HistoAccumulator& operator=(const HistoAccumulator&);
+
+    std::unordered_map<std::string, int> lookup_;      // name -> position in histos_
+    std::vector<std::pair<TString, TH1*> > histos_;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef HISTOPOOL_H
+#define HISTOPOOL_H
+
+#include "TFile.h"
+#include "TH1.h"
+
+#include <mutex>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // HistoPool
+  // *
+  // *      Owns the histograms read from an input file, in groups (one per
+  // *      directory) that can be freed as soon as they are done with:
+  // *
+  // *          HistoPool histos(nDirs);
+  // *          TH1 *h = histos.adopt(idir, (TH1*) key->ReadObj());
+  // *          ...
+  // *          histos.release(idir);     // h is gone
+  // *
+  // *      Adopted histograms are taken out of their ROOT directory, so
+  // *      closing the file does not delete them and nothing else holds
+  // *      them. adopt() may be called from ThreadPool workers; release()
+  // *      and clear() only when no worker uses the group. The number of
+  // *      histograms held and their estimated size (from the bins) are
+  // *      tracked with their peaks.
+  // *------------------------------------------------------------------------
+
+class HistoPool {
+  public:
+    explicit HistoPool(int nGroups = 0);
+    ~HistoPool();
+
+    // frees everything and starts over with nGroups empty groups
+    void setGroups(int nGroups);
+    int groups() const { return groups_.size(); }
+
+    // takes ownership of histo for the group, returns it (0 stays 0)
+    TH1 *adopt(int group, TH1 *histo);
+
+    // frees the histograms of a group, or of all of them
+    void release(int group);
+    void clear();
+
+    int size() const { return size_; }
+    int peak() const { return peak_; }
+    Long64_t bytes() const { return bytes_; }
+    Long64_t peakBytes() const { return peakBytes_; }
+
+  private:
+    HistoPool(const HistoPool&);
+    HistoPool& operator=(const HistoPool&);
+
+    static Long64_t estimate(const TH1 *histo);
+
+    std::mutex mutex_;
+    std::vector<std::vector<TH1*> > groups_;
+    int size_, peak_;
+    Long64_t bytes_, peakBytes_;
+};
+
+  //--------------------------------------------------------------------------
+  // ScopedFile
+  // *
+  // *      A TFile closed and deleted when the handle goes out of scope:
+  // *
+  // *          ScopedFile f("plotter.root");
+  // *          if(!f.isOpen()) ...
+  // *          TDirectory *dir = (TDirectory*) f->Get("mlbwa_EE_Mlb");
+  // *
+  // *      Opening the file leaves gDirectory where it was.
+  // *------------------------------------------------------------------------
+
+class ScopedFile {
+  public:
+    explicit ScopedFile(const char *fileName, Option_t *option = "READ");
+    ~ScopedFile();
+
+    bool isOpen() const { return file_ != 0 && !file_->IsZombie(); }
+    TFile *get() const { return file_; }
+    TFile *operator->() const { return file_; }
+
+  private:
+    ScopedFile(const ScopedFile&);
+    ScopedFile& operator=(const ScopedFile&);
+
+    TFile *file_;
+};
+
+#endif
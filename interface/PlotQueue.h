@@ -0,0 +1,62 @@
+#ifndef PLOTQUEUE_H
+#define PLOTQUEUE_H
+
+#include "TCanvas.h"
+#include "TString.h"
+
+#include <sys/types.h>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // PlotQueue
+  // *
+  // *      Canvases whose files are written later, all in one go:
+  // *
+  // *          PlotQueue plots;
+  // *          plots.add(c, "fit_result/ll_EE_MM", "C png pdf");  // copy of c
+  // *          ...
+  // *          plots.flush(true);     // written by a forked process
+  // *          plots.wait();
+  // *
+  // *      add() paints the canvas once, so statistics boxes and the like
+  // *      are made with the style of that moment, and keeps a copy of it
+  // *      along with the gStyle stat and fit options; the caller can go on
+  // *      drawing into the canvas. flush() writes every format of every
+  // *      canvas, here or, in batch mode, in a forked child so the caller
+  // *      goes on fitting meanwhile (ROOT graphics are not thread safe, so
+  // *      there is no rendering thread). One child runs at a time, wait()
+  // *      reaps it.
+  // *------------------------------------------------------------------------
+
+class PlotQueue {
+  public:
+    PlotQueue();
+    ~PlotQueue();
+
+    void add(TCanvas *canvas, const TString &baseName, const TString &formats = "C png pdf");
+    int size() const { return entries_.size(); }
+
+    // writes baseName.<format> for everything queued; returns the number
+    // of files (to be) written
+    int flush(bool background);
+
+    // waits for the child of the last flush(true); false if it failed
+    bool wait();
+
+  private:
+    PlotQueue(const PlotQueue&);
+    PlotQueue& operator=(const PlotQueue&);
+
+    struct Entry {
+      TCanvas *canvas;
+      TString baseName, formats;
+      int optStat, optFit;
+    };
+    static int render(const Entry &entry);
+
+    std::vector<Entry> entries_;
+    pid_t child_;
+    int counter_;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef PROCESSCLASSIFIER_H
+#define PROCESSCLASSIFIER_H
+
+#include "TString.h"
+#include "TRegexp.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // ProcessClassifier
+  // *
+  // *      Classifies the histogram names of the mlbwidth plotter output, i.e.
+  // *
+  // *          MC8TeV_TTJets_widthx5_mlbwa_EE_Mlb -> (TTbar, EE, signal)
+  // *
+  // *      The procs regular expressions are compiled once, in the
+  // *      constructor, and every name is only parsed the first time it is
+  // *      seen; later calls are a map lookup. The lookups take a lock, so
+  // *      one classifier can be shared by the threads and jobs of a run;
+  // *      the ProcessInfo references stay valid as long as it does.
+  // *
+  // * Input arguments:
+  // * ================
+  // * procs, procReplace : the process regular expressions and the names
+  // *                      they are replaced with in the MassFit output,
+  // *                      both of size nProcs
+  // *
+  // * signalNames        : the procReplace names that get the signal width
+  // *                      appended, of size nSignals
+  // *
+  // * The tables are not copied and have to outlive the classifier.
+  // *------------------------------------------------------------------------
+
+// What a plotter histogram name resolves to
+struct ProcessInfo {
+  int     proc;       // index into procs, -1 for data or no match
+  bool    isData;
+  bool    isSignal;
+  TString process;    // procReplace name, "Data", or the raw process token
+  TString lepton;     // E, EE, EM, MM, M
+};
+
+class ProcessClassifier {
+  public:
+    ProcessClassifier(const char* const* procs, const char* const* procReplace, int nProcs,
+                      const char* const* signalNames, int nSignals);
+    ~ProcessClassifier();
+
+    // process, lepton and signal flag of a plotter histogram name
+    const ProcessInfo& classify(const char* histoName);
+
+    // mlbwa__<Process>_<lep>, or mlbwa__<Process>_<width>_<lep> for signals
+    TString formatName(const char* histoName, double signalWidth);
+
+    // bit j is set if the key name matches procs[j]
+    UInt_t matchMask(const char* keyName);
+
+    int size() const { return nProcs_; }
+
+  private:
+    ProcessClassifier(const ProcessClassifier&);
+    ProcessClassifier& operator=(const ProcessClassifier&);
+
+    // classify() with mutex_ held
+    const ProcessInfo& classifyLocked(const char* histoName);
+
+    const char* const* procReplace_;
+    const char* const* signalNames_;
+    int nProcs_, nSignals_;
+
+    std::vector<TRegexp*> patterns_;
+    std::map<std::string, ProcessInfo> infos_;
+    std::map<std::string, UInt_t> masks_;
+    std::mutex mutex_;
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef RUNSTATS_H
+#define RUNSTATS_H
+
+#include "TString.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // RunStats
+  // *
+  // *      The counters and timers of a run, and how much it prints:
+  // *
+  // *          RUNSTATS_COUNT(kMorphs, 1);
+  // *          RUNSTATS_TIMER("fitPoint");     // until the end of the scope
+  // *          RUNSTATS_LOG(kDebug)<<" - classified "<<name<<endl;
+  // *          RunStats::instance().setReport("run.json");
+  // *
+  // *      The report (JSON, or CSV if the name ends in .csv) is written
+  // *      when the program exits, to $RUNSTATS_REPORT if setReport() is not
+  // *      called. Besides the counters and timers it has the wall time of
+  // *      the run, the bytes read by all TFiles and the peak resident
+  // *      memory of the process (and of its finished children, i.e. the
+  // *      forked toy workers).
+  // *
+  // *      The counters are atomic and the timers take a lock, so both can
+  // *      be used from ThreadPool workers. Compiled with -DRUNSTATS_DISABLED
+  // *      RUNSTATS_COUNT and RUNSTATS_TIMER expand to nothing; RUNSTATS_LOG
+  // *      stays, the level is set at run time (kInfo unless changed).
+  // *------------------------------------------------------------------------
+
+class RunStats {
+  public:
+    enum Counter { kFileOpens = 0, kObjectReads, kHistoClones, kMorphs, kFits,
+                   kFcnCalls, kToys, kToyRetries, kTemplateLoads, kTemplateEvictions,
+                   kCounters };
+    enum Level { kError = 0, kWarning, kInfo, kDebug };
+
+    static RunStats &instance() { static RunStats stats; return stats; }
+
+    void count(Counter c, Long64_t n = 1) { counters_[c].fetch_add(n, std::memory_order_relaxed); }
+    Long64_t counter(Counter c) const { return counters_[c].load(std::memory_order_relaxed); }
+    static const char *counterName(Counter c);
+
+    // adds a call of seconds to the timer name, timers are reported in the
+    // order they were first used
+    void addTime(const char *name, double seconds);
+
+    static bool logs(Level level) { return instance().level_ >= level; }
+    void setLevel(Level level) { level_ = level; }
+    Level level() const { return (Level) level_.load(); }
+
+    // the largest resident set size so far in kB, children counts the
+    // waited-for child processes instead
+    static Long64_t peakRss(bool children = false);
+
+    // where the report goes at exit, "" for nowhere
+    void setReport(const char *fileName);
+
+    // returns false (with a message) if fileName could not be written
+    bool writeReport(const char *fileName) const;
+
+    // the counters and timers as a table on cout
+    void print() const;
+
+  private:
+    RunStats();
+    RunStats(const RunStats&);
+    RunStats& operator=(const RunStats&);
+
+    static void reportAtExit();
+
+    struct Timer {
+      Long64_t calls;
+      double seconds;
+    };
+
+    std::atomic<Long64_t> counters_[kCounters];
+    std::atomic<int> level_;
+    std::chrono::steady_clock::time_point start_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::pair<std::string, Timer> > timers_;
+    std::string report_;
+    bool atExit_;
+};
+
+// Adds the time between its construction and its destruction to a RunStats
+// timer
+class ScopedTimer {
+  public:
+    explicit ScopedTimer(const char *name) : name_(name), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+      RunStats::instance().addTime(name_, std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() - start_).count());
+    }
+
+  private:
+    ScopedTimer(const ScopedTimer&);
+    ScopedTimer& operator=(const ScopedTimer&);
+
+    const char *name_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#ifndef RUNSTATS_DISABLED
+#define RUNSTATS_COUNT(counter, n) RunStats::instance().count(RunStats::counter, (n))
+#define RUNSTATS_TIMER(name) ScopedTimer runStatsTimer_(name)
+#else
+#define RUNSTATS_COUNT(counter, n) ((void) 0)
+#define RUNSTATS_TIMER(name) ((void) 0)
+#endif
+
+#define RUNSTATS_LOG(level) if(!RunStats::logs(RunStats::level)) {} else std::cout
+// the same, to another stream (i.e. the output of one of several jobs)
+#define RUNSTATS_LOG_TO(level, out) if(!RunStats::logs(RunStats::level)) {} else (out)
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef TEMPLATECACHE_H
+#define TEMPLATECACHE_H
+
+#include "TH1.h"
+#include "TObject.h"
+
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // TemplateCache
+  // *
+  // *      Histograms loaded on first use and kept up to a memory budget,
+  // *      the least recently used ones are dropped first:
+  // *
+  // *          TemplateCache cache(32 << 20);
+  // *          cache.setLoader([&](const std::string &key) { return ...; });
+  // *          TH1 *h = cache.get("mlbwa__EE_pdf12");
+  // *          cache.attach("mlbwa__EE_pdf12", pdf, 8192);   // goes with h
+  // *
+  // *      The loader returns a histogram the cache then owns (0 if there is
+  // *      none). Objects built from a histogram, i.e. its RooHistPdf, can
+  // *      be attached to it with their estimated size; they are deleted
+  // *      with it, the last attached first. The size of a histogram is
+  // *      estimated from its bins.
+  // *
+  // *      Loading one entry can evict any other, so what get() and
+  // *      attached() return is only good until the next get(). The entry
+  // *      just loaded is never evicted, even alone over the budget. The
+  // *      eviction callback is told the key before the entry is deleted.
+  // *------------------------------------------------------------------------
+
+class TemplateCache {
+  public:
+    typedef std::function<TH1*(const std::string&)> Loader;
+    typedef std::function<void(const std::string&)> Evicted;
+
+    // maxBytes <= 0 for no limit
+    explicit TemplateCache(Long64_t maxBytes = 0);
+    ~TemplateCache();
+
+    void setLoader(const Loader &loader) { loader_ = loader; }
+    void setEvicted(const Evicted &evicted) { evicted_ = evicted; }
+    void setMaxBytes(Long64_t maxBytes);
+
+    // the histogram of key, loaded if it is not there; 0 if the loader has none
+    TH1 *get(const std::string &key);
+    bool contains(const std::string &key) const { return entries_.count(key) != 0; }
+
+    void attach(const std::string &key, TObject *object, Long64_t bytes);
+    const std::vector<TObject*> &attached(const std::string &key) const;
+
+    // deletes everything
+    void clear();
+
+    int size() const { return entries_.size(); }
+    Long64_t bytes() const { return bytes_; }
+    Long64_t peakBytes() const { return peakBytes_; }
+    Long64_t maxBytes() const { return maxBytes_; }
+    long loads() const { return loads_; }
+    long evictions() const { return evictions_; }
+
+  private:
+    TemplateCache(const TemplateCache&);
+    TemplateCache& operator=(const TemplateCache&);
+
+    struct Entry {
+      TH1 *histo;
+      std::vector<TObject*> attached;
+      Long64_t bytes;
+      std::list<std::string>::iterator use;   // position in uses_
+    };
+
+    void drop(std::unordered_map<std::string, Entry>::iterator entry);
+    void shrink(const std::string &keep);
+
+    Loader loader_;
+    Evicted evicted_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> uses_;                  // most recently used first
+    Long64_t maxBytes_, bytes_, peakBytes_;
+    long loads_, evictions_;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef TEMPLATESTORE_H
+#define TEMPLATESTORE_H
+
+#include "TH1.h"
+
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // TemplateStore
+  // *
+  // *      The histograms of a fit indexed by component, channel and
+  // *      template (width or pdf index) instead of by name:
+  // *
+  // *          TemplateStore store;
+  // *          store.reset(5, 0., 400.);
+  // *          store.setCount(TemplateStore::kSignal, 5);
+  // *          store.set(TemplateStore::kSignal, itype, i, histo);
+  // *          double mu = store.windowIntegral(TemplateStore::kSignal, itype, i);
+  // *
+  // *      The bin contents (under/overflow included) of all histograms sit
+  // *      in one contiguous array; the integral over the bins and the one
+  // *      over the mass window, i.e. Integral(FindBin(lower),
+  // *      FindBin(upper)), are computed when a histogram is set. The
+  // *      histograms are not copied and stay with their owner, so they have
+  // *      to be set again if they change. Setting a slot again with the
+  // *      same number of bins overwrites its contents in place, so a
+  // *      template evicted and reloaded by a TemplateCache takes no more
+  // *      memory; only a new binning appends them.
+  // *------------------------------------------------------------------------
+
+class TemplateStore {
+  public:
+    enum Component { kSignal = 0, kSignalGen, kBackground, kBackgroundGen,
+                     kBackgroundSample, kComponents };
+
+    TemplateStore();
+
+    // forgets everything; nChannels channels, [lower, upper] the mass window
+    void reset(int nChannels, double lower, double upper);
+
+    // templates per channel of component c, 1 unless set; before any set()
+    void setCount(Component c, int count);
+
+    void set(Component c, int channel, int index, TH1 *histo);
+
+    // the histogram of the slot is gone (i.e. evicted from a TemplateCache):
+    // has() is false until it is set again, the integrals stay
+    void release(Component c, int channel, int index);
+
+    int channels() const { return nChannels_; }
+    int count(Component c) const { return count_[c]; }
+    bool has(Component c, int channel, int index) const;
+
+    TH1 *histo(Component c, int channel, int index = 0) const { return histos_[slot(c, channel, index)]; }
+    int nbins(Component c, int channel, int index = 0) const { return nbins_[slot(c, channel, index)]; }
+
+    // bins 0 (underflow) to nbins+1 (overflow); until the next set()
+    const double *contents(Component c, int channel, int index = 0) const
+      { return &contents_[offset_[slot(c, channel, index)]]; }
+
+    // as TH1::Integral() and TH1::Integral(FindBin(lower), FindBin(upper))
+    double integral(Component c, int channel, int index = 0) const { return integral_[slot(c, channel, index)]; }
+    double windowIntegral(Component c, int channel, int index = 0) const { return window_[slot(c, channel, index)]; }
+    double integral(Component c, int channel, int index, double lower, double upper) const;
+
+  private:
+    int slot(Component c, int channel, int index) const { return first_[c] + channel*count_[c] + index; }
+    void layout();
+    double sum(int s, int binLow, int binHigh) const;
+
+    int nChannels_;
+    double lower_, upper_;
+    int count_[kComponents], first_[kComponents];
+
+    std::vector<TH1*> histos_;             // per slot, 0 if not set
+    std::vector<int> offset_, nbins_;      // where the slot's contents start
+    std::vector<double> contents_;
+    std::vector<double> integral_, window_;
+};
+
+#endif
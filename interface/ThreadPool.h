@@ -0,0 +1,56 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // ThreadPool
+  // *
+  // *      A fixed set of worker threads that run indexed tasks:
+  // *
+  // *          pool.run(nTasks, [&](int task, int worker) { ... });
+  // *
+  // *      runs the function once for every task = 0..nTasks-1 and returns 
+  // *      when all of them are done. worker = 0..size()-1 identifies the 
+  // *      thread a task runs on, so per-worker resources (i.e. a read-only
+  // *      TFile handle) can be kept in a vector indexed by it. 
+  // *
+  // *      A pool of size 1 (or less) starts no threads and runs the tasks in 
+  // *      order on the calling thread.
+  // *
+  // *      If a task throws, the tasks not started yet are skipped and run()
+  // *      rethrows the first exception once the running ones are done.
+  // *------------------------------------------------------------------------
+
+class ThreadPool {
+  public:
+    explicit ThreadPool(int nThreads);
+    ~ThreadPool();
+
+    int size() const { return (threads_.empty() ? 1 : (int) threads_.size()); }
+
+    void run(int nTasks, const std::function<void(int,int)> &fn);
+
+  private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void work(int worker);
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+
+    const std::function<void(int,int)> *job_;
+    int nTasks_, nextTask_, nDone_;
+    std::exception_ptr error_;               // the first exception of the job
+    unsigned long generation_;
+    bool stop_;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef TOYPRECISION_H
+#define TOYPRECISION_H
+
+  //--------------------------------------------------------------------------
+  // ToyPrecision
+  // *
+  // *      Running estimates of what the toys of one template calibrate,
+  // *      the mean bias and the pull width, with their statistical errors,
+  // *      so the toys can stop once these are known well enough:
+  // *
+  // *          ToyPrecision precision;
+  // *          precision.add(mean - width, (width - mean)/error);  // per toy
+  // *          if(precision.converged(0.01, 0.02, 100)) ...
+  // *
+  // *      The error of the mean bias is s/sqrt(n), the one of the pull
+  // *      width (its standard deviation s) s/sqrt(2(n-1)), as for a
+  // *      Gaussian. Mean and variance are accumulated with Welford's
+  // *      update, so the order of the toys only changes the roundings.
+  // *------------------------------------------------------------------------
+
+class ToyPrecision {
+  public:
+    ToyPrecision();
+
+    void reset();
+    void add(double bias, double pull);
+
+    int toys() const { return n_; }
+    double bias() const { return biasMean_; }
+    double biasError() const;
+    double pullMean() const { return pullMean_; }
+    double pullWidth() const;
+    double pullWidthError() const;
+
+    // both errors at or below their targets (a target <= 0 is not looked
+    // at), after at least minToys toys
+    bool converged(double biasTarget, double pullWidthTarget, int minToys) const;
+
+  private:
+    int n_;
+    double biasMean_, biasM2_;
+    double pullMean_, pullM2_;
+};
+
+#endif
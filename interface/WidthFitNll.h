@@ -0,0 +1,71 @@
+#ifndef WIDTHFITNLL_H
+#define WIDTHFITNLL_H
+
+#include "Minuit2/FCNBase.h"
+
+#include "BinnedTemplateNll.h"
+#include "WidthTemplateGrid.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // WidthFitNll
+  // *
+  // *      The likelihood of a BinnedTemplateNll with the signal templates
+  // *      morphed to a floating width, so the width comes out of a single
+  // *      minimisation instead of a scan over the template grid:
+  // *
+  // *          WidthFitNll fcn(nll);     // nll has the data and background
+  // *          fcn.addChannel(gridEE, lowEE, highEE); ...
+  // *          par = (width, parameters of nll); migradMinimum(fcn, par, ...)
+  // *
+  // *      Each channel morphs its signal through a WidthTemplateGrid, which
+  // *      keeps the cdf's of the anchor pairs, and spreads the morphed bins
+  // *      over the data bins [low[r], high[r]) of the channel by overlap,
+  // *      the template being flat within a bin as in a RooHistPdf. The
+  // *      overlaps are worked out once per anchor pair and the shapes are
+  // *      only redone when the width changes.
+  // *
+  // *      Minuit2 differentiates numerically. nll, the grids and this
+  // *      object's buffers are shared, so it is used from one thread.
+  // *------------------------------------------------------------------------
+
+class WidthFitNll : public ROOT::Minuit2::FCNBase {
+  public:
+    WidthFitNll(BinnedTemplateNll &nll);
+
+    // the next channel of nll, with its data bins in the order nll has them
+    void addChannel(WidthTemplateGrid *grid, const std::vector<double> &low,
+                    const std::vector<double> &high);
+
+    // gives nll the signal shapes at width
+    void shapesAt(double width) const;
+
+    double operator()(const std::vector<double> &par) const;
+    double Up() const { return 0.5; }
+
+  private:
+    WidthFitNll(const WidthFitNll&);
+    WidthFitNll& operator=(const WidthFitNll&);
+
+    // morphed bin -> data bin, with the fraction of the morphed bin in it
+    struct Projection {
+      std::vector<int> bin, row;
+      std::vector<double> fraction;
+    };
+    const Projection &projection(int channel, int pair, const std::vector<double> &edges) const;
+
+    BinnedTemplateNll &nll_;
+    std::vector<WidthTemplateGrid*> grids_;
+    std::vector<std::vector<double> > low_, high_;
+    std::vector<int> first_;
+
+    mutable std::map<std::pair<int,int>, Projection> projections_;   // (channel, pair)
+    mutable std::vector<double> contents_, edges_, signal_;
+    mutable double width_;
+    mutable bool shapesSet_;
+};
+
+#endif
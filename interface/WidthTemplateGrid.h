@@ -0,0 +1,83 @@
+#ifndef WIDTHTEMPLATEGRID_H
+#define WIDTHTEMPLATEGRID_H
+
+#include "TH1.h"
+#include "TH1D.h"
+#include "TH1F.h"
+#include "TString.h"
+
+#include "th1fmorph.h"
+
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // WidthTemplateGrid
+  // *
+  // *      The signal templates of one channel at every width we have a
+  // *      sample for (the anchors), and the template at any other width,
+  // *      morphed from the two anchors bracketing it:
+  // *
+  // *          WidthTemplateGrid grid;
+  // *          grid.addAnchor(1.5, h15); ... grid.addAnchor(7.5, h75);
+  // *          TH1F *h = grid.templateAt(4.2, "mlbwa__TTbar_4.20_EE");
+  // *
+  // *      Outside the grid the first/last pair is extrapolated (with the
+  // *      usual th1fmorph warning). The morpher of every anchor pair, i.e.
+  // *      the cdf's of both anchors and the walk over them, is built the
+  // *      first time a width in that pair is asked for and kept, so a dense
+  // *      scan only pays for the projection onto the binning.
+  // *
+  // *      contentsAt() skips the histogram altogether, for scans that only
+  // *      need the bin contents.
+  // *
+  // *      The anchors are copied (as TH1D, the templates come out as TH1F
+  // *      not attached to any directory). The cached morphers reuse their
+  // *      buffers, so a grid is used from one thread at a time.
+  // *------------------------------------------------------------------------
+
+class WidthTemplateGrid {
+  public:
+    WidthTemplateGrid();
+    ~WidthTemplateGrid();
+
+    // adds a copy of the template at width, the anchors are kept sorted
+    void addAnchor(double width, const TH1 *histo);
+
+    int size() const { return widths_.size(); }
+    double width(int i) const { return widths_[i]; }
+    const TH1D *anchor(int i) const { return anchors_[i]; }
+
+    // false (with a message) if there are fewer than two anchors or two
+    // of them have the same width
+    bool isValid() const;
+
+    // the anchor pair (i, i+1) used for width: the one bracketing it, the
+    // first or the last one
+    int bracket(double width) const;
+
+    // the template at width normalised to norm, or to the anchor integrals
+    // interpolated linearly to width if norm < 0; the caller owns it
+    TH1F *templateAt(double width, const char *name, double norm = -1);
+    std::vector<TH1F*> templatesAt(const std::vector<double> &widths,
+                                   const std::vector<TString> &names, double norm = -1);
+
+    // the bin contents at width, edges (if given) gets the nbins+1 edges;
+    // returns the number of bins
+    int contentsAt(double width, double norm, std::vector<double> &contents,
+                   std::vector<double> *edges = 0);
+
+    double integralAt(double width) const;
+
+  private:
+    WidthTemplateGrid(const WidthTemplateGrid&);
+    WidthTemplateGrid& operator=(const WidthTemplateGrid&);
+
+    TH1DMorpher *morpher(int pair);
+
+    std::vector<double> widths_;
+    std::vector<TH1D*> anchors_;
+    std::vector<double> integrals_;
+    std::vector<TH1DMorpher*> morphers_;   // one per anchor pair, built on first use
+};
+
+#endif
@@ -1,71 +1,140 @@
-#include "TH1.h"
-
-TH1F *th1fmorph(const char *chname,
-                const char *chtitle,
-                TH1F *hist1,TH1F *hist2,
-                Double_t par1,Double_t par2,Double_t parinterp,
-                Double_t morphedhistnorm,
-                Int_t idebug=0) ;
-TH1D *th1dmorph(const char *chname,
-                const char *chtitle,
-                TH1D *hist1,TH1D *hist2,
-                Double_t par1,Double_t par2,Double_t parinterp,
-                Double_t morphedhistnorm,
-                Int_t idebug=0) ;
-  //--------------------------------------------------------------------------
-  // Author           : Alex Read
-  // Version 0.2 of ROOT implementation, 08.05.2011
-  // *
-  // *      Perform a linear interpolation between two histograms as a function
-  // *      of the characteristic parameter of the distribution.
-  // *
-  // *      The algorithm is described in Read, A. L., "Linear Interpolation
-  // *      of Histograms", NIM A 425 (1999) 357-360.
-  // *
-  // *      This ROOT-based CINT implementation is based on the FORTRAN77
-  // *      implementation used by the DELPHI experiment at LEP (d_pvmorph.f).
-  // *      The use of double precision allows pdf's to be accurately
-  // *      interpolated down to something like 10**-15.
-  // *
-  // *      The input histograms don't have to be identical, the binning is also
-  // *      interpolated.
-  // *
-  // *      Extrapolation is allowed (a warning is given) but the extrapolation
-  // *      is not as well-defined as the interpolation and the results should
-  // *      be used with great care.
-  // *
-  // *      Data in the underflow and overflow bins are completely ignored.
-  // *      They are neither interpolated nor do they contribute to the
-  // *      normalization of the histograms.
-  // *
-  // * Input arguments:
-  // * ================
-  // * chname, chtitle : The ROOT name and title of the interpolated histogram.
-  // *                   Defaults for the name and title are "THF1-interpolated"
-  // *                   and "Interpolated histogram", respectively.
-  // *
-  // * hist1, hist2    : The two input histograms.
-  // *
-  // * par1,par2       : The values of the linear parameter that characterises
-  // *                   the histograms (e.g. a particle mass).
-  // *
-  // * parinterp       : The value of the linear parameter we wish to
-  // *                   interpolate to.
-  // *
-  // * morphedhistnorm : The normalization of the interpolated histogram
-  // *                   (default is 1.0).
-  // *
-  // * idebug          : Default is zero, no internal information displayed.
-  // *                   Values between 1 and increase the verbosity of
-  // *                   informational output which may prove helpful to
-  // *                   understand errors and pathalogical results.
-  // *
-  // * The routine returns a pointer (TH1 *) to a new histogram which is
-  // * the interpolated result.
-  // *
-  // *------------------------------------------------------------------------
-  // Changes from 0.1 to 0.2:
-  // o Treatment of empty and non-existing histograms now well-defined.
-  // o The tricky regions of the first and last bins are improved (and
-  //   well-tested).
-  // *------------------------------------------------------------------------
+#ifndef TH1FMORPH_H
+#define TH1FMORPH_H
+
+#include "TH1.h"
+#include "TString.h"
+
+#include "th1fmorph_core.h"
+
+#include <vector>
+
+TH1F *th1fmorph(const char *chname,
+                const char *chtitle,
+                TH1F *hist1,TH1F *hist2,
+                Double_t par1,Double_t par2,Double_t parinterp,
+                Double_t morphedhistnorm,
+                Int_t idebug=0) ;
+TH1D *th1dmorph(const char *chname,
+                const char *chtitle,
+                TH1D *hist1,TH1D *hist2,
+                Double_t par1,Double_t par2,Double_t parinterp,
+                Double_t morphedhistnorm,
+                Int_t idebug=0) ;
+  //--------------------------------------------------------------------------
+  // Author           : Alex Read
+  // Version 0.2 of ROOT implementation, 08.05.2011
+  // *
+  // *      Perform a linear interpolation between two histograms as a function
+  // *      of the characteristic parameter of the distribution.
+  // *
+  // *      The algorithm is described in Read, A. L., "Linear Interpolation
+  // *      of Histograms", NIM A 425 (1999) 357-360.
+  // *
+  // *      This ROOT-based CINT implementation is based on the FORTRAN77
+  // *      implementation used by the DELPHI experiment at LEP (d_pvmorph.f).
+  // *      The use of double precision allows pdf's to be accurately
+  // *      interpolated down to something like 10**-15.
+  // *
+  // *      The input histograms don't have to be identical, the binning is also
+  // *      interpolated.
+  // *
+  // *      Extrapolation is allowed (a warning is given) but the extrapolation
+  // *      is not as well-defined as the interpolation and the results should
+  // *      be used with great care.
+  // *
+  // *      Data in the underflow and overflow bins are completely ignored.
+  // *      They are neither interpolated nor do they contribute to the
+  // *      normalization of the histograms.
+  // *
+  // * Input arguments:
+  // * ================
+  // * chname, chtitle : The ROOT name and title of the interpolated histogram.
+  // *                   Defaults for the name and title are "THF1-interpolated"
+  // *                   and "Interpolated histogram", respectively.
+  // *
+  // * hist1, hist2    : The two input histograms.
+  // *
+  // * par1,par2       : The values of the linear parameter that characterises
+  // *                   the histograms (e.g. a particle mass).
+  // *
+  // * parinterp       : The value of the linear parameter we wish to
+  // *                   interpolate to.
+  // *
+  // * morphedhistnorm : The normalization of the interpolated histogram
+  // *                   (default is 1.0).
+  // *
+  // * idebug          : Default is zero, no internal information displayed.
+  // *                   Values between 1 and increase the verbosity of
+  // *                   informational output which may prove helpful to
+  // *                   understand errors and pathalogical results.
+  // *
+  // * The routine returns a pointer (TH1 *) to a new histogram which is
+  // * the interpolated result.
+  // *
+  // *------------------------------------------------------------------------
+  // Changes from 0.1 to 0.2:
+  // o Treatment of empty and non-existing histograms now well-defined.
+  // o The tricky regions of the first and last bins are improved (and
+  //   well-tested).
+  // *------------------------------------------------------------------------
+
+  //--------------------------------------------------------------------------
+  // TH1Morpher
+  // *
+  // *      The same interpolation, split in the part that only depends on
+  // *      the two input histograms and the part that depends on parinterp.
+  // *      The constructor builds the union of the bin edges, both cdf's and
+  // *      the walk over their edges once; each morph() call then only
+  // *      places the walk at the weights of parinterp and projects it onto
+  // *      the new binning.  th1fmorph/th1dmorph are a morpher used once.
+  // *
+  // *      The arithmetic is MorphCore (th1fmorph_core.h), this class moves
+  // *      the histograms in and out of it and prints its warnings; idebug
+  // *      only prints the binning, sums and weights.
+  // *
+  // *      morph(chnames, parinterps, ...) returns one histogram per
+  // *      interpolation point, named chnames[k] (also used as title).
+  // *
+  // *      The contents are read with GetBinContent, so a TH1D handed over
+  // *      as a TH1F (or the other way around) is read correctly.
+  // *
+  // *      morph() reuses the morpher's buffers: one morpher per thread.
+  // *------------------------------------------------------------------------
+
+template<typename TH1_t>
+class TH1Morpher {
+  public:
+    TH1Morpher(TH1_t *hist1, TH1_t *hist2, Double_t par1, Double_t par2, Int_t idebug=0);
+
+    TH1_t *morph(const char *chname, const char *chtitle, Double_t parinterp,
+                 Double_t morphedhistnorm);
+    std::vector<TH1_t*> morph(const std::vector<TString> &chnames,
+                              const std::vector<Double_t> &parinterps,
+                              Double_t morphedhistnorm);
+
+    // the nbins() morphed contents only, valid until the next call
+    const std::vector<Double_t> &morphContents(Double_t parinterp, Double_t morphedhistnorm);
+
+    // false if one of the input histograms didn't exist
+    bool isValid() const { return valid_; }
+
+    // binning of the result, the union of the input bin edges
+    Int_t nbins() const { return core_.nbins(); }
+    const Double_t *edges() const { return core_.edges(); }
+
+  private:
+    TH1Morpher(const TH1Morpher&);
+    TH1Morpher& operator=(const TH1Morpher&);
+
+    bool valid_;
+    Double_t par1_, par2_;
+    Int_t idebug_;
+
+    MorphCore core_;
+    std::vector<Double_t> contents_;  // the morphed contents, before they go in a TH1
+};
+
+typedef TH1Morpher<TH1F> TH1FMorpher;
+typedef TH1Morpher<TH1D> TH1DMorpher;
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef TH1FMORPH_CORE_H
+#define TH1FMORPH_CORE_H
+
+#include <vector>
+
+  //--------------------------------------------------------------------------
+  // MorphCore
+  // *
+  // *      The arithmetic of th1fmorph (A. L. Read, NIM A 425 (1999) 357)
+  // *      on plain arrays, without ROOT and without printing anything, so
+  // *      it can be checked and timed on its own (see bench/MorphBench.C).
+  // *      TH1Morpher is a thin ROOT wrapper around it.
+  // *
+  // *      set() takes the two input histograms as
+  // *
+  // *          edges    : the nb+1 ascending bin edges
+  // *          contents : the nb bin contents (no underflow/overflow)
+  // *          widths2  : optional, the nb bin widths of the second input as
+  // *                     TAxis::GetBinWidth gives them; by default the edge
+  // *                     differences are used
+  // *
+  // *      and builds the merged edges, both cdf's and the walk over them.
+  // *      morph() then writes the nbins() contents of the histogram at
+  // *      weights (wt1, wt2) into out, using a caller-provided scratch
+  // *      area of scratchSize() doubles, or the core's own one.
+  // *
+  // *      All the arrays live in buffers owned by the core that only grow,
+  // *      so a core reused for many pairs stops allocating once it has seen
+  // *      the largest one.
+  // *------------------------------------------------------------------------
+
+// what set()/morph() ran into, or'ed together; th1fmorph prints the warnings
+enum MorphStatus {
+  kMorphOk            = 0,
+  kMorphEmpty         = 1,   // an input has no content, the result is empty
+  kMorphExtrapolation = 2,   // the weights are outside [0,1] or don't sum to 1
+  kMorphZeroSlope     = 4    // the interpolated cdf was flat where it was solved
+};
+
+// The weights of the two inputs at parinterp, returns kMorphExtrapolation if
+// this is not an interpolation
+int morphWeights(double par1, double par2, double parinterp, double &wt1, double &wt2);
+
+// Merges two ascending edge lists into merged (room for n1+n2 entries),
+// dropping duplicates; returns the number of merged edges
+int morphMergeEdges(const double *edges1, int n1, const double *edges2, int n2, double *merged);
+
+// The normalised cdf of nb contents into cdf[0..nb]; returns the total
+double morphCdf(const double *contents, int nb, double *cdf);
+
+class MorphCore {
+  public:
+    MorphCore();
+
+    int set(const double *edges1, const double *contents1, int nb1,
+            const double *edges2, const double *contents2, int nb2,
+            const double *widths2 = 0);
+
+    int morph(double wt1, double wt2, double norm, double *out, double *scratch);
+    int morph(double wt1, double wt2, double norm, double *out);
+
+    // the merged binning of the result
+    int nbins() const { return nbn_; }
+    const double *edges() const { return bedgesn_; }
+
+    int scratchSize() const { return nmax_ + nbn_ + 1; }
+
+    bool empty() const { return empty_; }
+
+  private:
+    MorphCore(const MorphCore&);
+    MorphCore& operator=(const MorphCore&);
+
+    double *grow(std::vector<double> &buffer, int size);
+
+    bool empty_;
+    int nb1_, nb2_, nbn_;
+    int nmax_;    // room for the walk, nb1+nb2+2 points
+    int npts_;    // points of the walk
+
+    std::vector<double> arena_, scratch_;
+
+    // views into arena_
+    double *edges1_, *edges2_;   // nb+2 edges, the last one repeated
+    double *cdf1_, *cdf2_;       // nb+2 points, the last one repeated
+    double *bedgesn_, *dx2_;     // merged edges, hist2 bin width at each of them
+    double *x1_, *x2_, *y_;      // the walk, zero beyond npts_
+};
+
+#endif
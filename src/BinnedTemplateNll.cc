@@ -0,0 +1,114 @@
+#include "../interface/BinnedTemplateNll.h"
+
+#include <cmath>
+
+BinnedTemplateNll::BinnedTemplateNll()
+  : parameterization_(kRatio), first_(1, 0)
+{
+}
+
+void BinnedTemplateNll::setChannels(const std::vector<int> &firstBin, int parameterization) {
+  first_ = firstBin;
+  parameterization_ = parameterization;
+  const int nbins = first_.back();
+  signal_.assign(nbins, 0.);
+  background_.assign(nbins, 0.);
+  counts_.assign(nbins, 0.);
+  pack();
+}
+
+void BinnedTemplateNll::setShapes(const double *signal, const double *background) {
+  signal_.assign(signal, signal+first_.back());
+  background_.assign(background, background+first_.back());
+  pack();
+}
+
+void BinnedTemplateNll::setSignal(const double *signal) {
+  signal_.assign(signal, signal+first_.back());
+  pack();
+}
+
+void BinnedTemplateNll::setData(const double *counts) {
+  counts_.assign(counts, counts+first_.back());
+  pack();
+}
+
+void BinnedTemplateNll::pack() {
+  const int nch = nChannels();
+  total_.assign(nch, 0.);
+  saturated_.assign(nch, 0.);
+  packedFirst_.assign(nch+1, 0);
+  packedCounts_.clear();
+  packedSignal_.clear();
+  packedBackground_.clear();
+
+  for(int c=0; c<nch; c++) {
+    packedFirst_[c] = packedCounts_.size();
+    for(int b=first_[c]; b<first_[c+1]; b++) {
+      total_[c] += counts_[b];
+      if(counts_[b] == 0) continue;
+      saturated_[c] += counts_[b]*std::log(counts_[b]) - counts_[b];
+      packedCounts_.push_back(counts_[b]);
+      packedSignal_.push_back(signal_[b]);
+      packedBackground_.push_back(background_[b]);
+    }
+  }
+  packedFirst_[nch] = packedCounts_.size();
+}
+
+double BinnedTemplateNll::value(const double *par) const {
+  const double *n = packedCounts_.empty() ? 0 : &packedCounts_[0];
+  const double *s = packedSignal_.empty() ? 0 : &packedSignal_[0];
+  const double *b = packedBackground_.empty() ? 0 : &packedBackground_[0];
+
+  double nll = 0;
+  for(int c=0; c<nChannels(); c++) {
+    // mu_b = ws s_b + wb b_b, sum_b mu_b = ws + wb
+    double ws, wb;
+    if(parameterization_ == kRatio) { ws = total_[c]*par[c]; wb = total_[c]-ws; }
+    else { ws = par[2*c]; wb = par[2*c+1]; }
+
+    double logL = 0;
+    for(int k=packedFirst_[c]; k<packedFirst_[c+1]; k++) logL += n[k]*std::log(ws*s[k] + wb*b[k]);
+    nll += ws + wb - logL + saturated_[c];
+  }
+  return nll;
+}
+
+void BinnedTemplateNll::gradient(const double *par, double *grad) const {
+  const double *n = packedCounts_.empty() ? 0 : &packedCounts_[0];
+  const double *s = packedSignal_.empty() ? 0 : &packedSignal_[0];
+  const double *b = packedBackground_.empty() ? 0 : &packedBackground_[0];
+
+  for(int c=0; c<nChannels(); c++) {
+    if(parameterization_ == kRatio) {
+      // N_c cancels: d/dr = -sum_b n_b (s_b - b_b) / (r s_b + (1-r) b_b)
+      const double r = par[c];
+      double d = 0;
+      for(int k=packedFirst_[c]; k<packedFirst_[c+1]; k++) d += n[k]*(s[k]-b[k])/(r*s[k] + (1-r)*b[k]);
+      grad[c] = -d;
+    } else {
+      const double ws = par[2*c], wb = par[2*c+1];
+      double ds = 0, db = 0;
+      for(int k=packedFirst_[c]; k<packedFirst_[c+1]; k++) {
+        const double w = n[k]/(ws*s[k] + wb*b[k]);
+        ds += w*s[k];
+        db += w*b[k];
+      }
+      grad[2*c] = 1 - ds;
+      grad[2*c+1] = 1 - db;
+    }
+  }
+}
+
+std::vector<double> BinnedTemplateNll::Gradient(const std::vector<double> &par) const {
+  std::vector<double> grad(par.size());
+  gradient(&par[0], &grad[0]);
+  return grad;
+}
+
+bool BinnedTemplateNll::minimize(std::vector<double> &par, const std::vector<double> &lower,
+                                 const std::vector<double> &upper, const std::vector<bool> &fixed,
+                                 double &minimum) const {
+  return migradMinimum(*this, par, lower, upper, fixed, minimum);
+}
@@ -0,0 +1,46 @@
+#include "../interface/FlatTemplateHisto.h"
+#include "../interface/RunStats.h"
+
+#include "TAxis.h"
+
+#include <vector>
+
+bool addFlatTemplate(FlatTemplateWriter &out, const TString &name, const TH1 *histo) {
+  const int nb = histo->GetNbinsX();
+  const TAxis *axis = histo->GetXaxis();
+  std::vector<double> edges(nb+1), contents(nb+2), sumw2;
+  // the upper edge as the axis keeps it, GetBinLowEdge(nb+1) can be off by
+  // a rounding on a fixed-width axis
+  for(int i=1; i<=nb; i++) edges[i-1] = axis->GetBinLowEdge(i);
+  edges[nb] = axis->GetXmax();
+  for(int i=0; i<=nb+1; i++) contents[i] = histo->GetBinContent(i);
+  if(histo->GetSumw2N() > 0) {
+    sumw2.resize(nb+2);
+    for(int i=0; i<=nb+1; i++) sumw2[i] = histo->GetSumw2()->At(i);
+  }
+
+  return out.add(name.Data(), nb, &edges[0], &contents[0], (sumw2.empty() ? 0 : &sumw2[0]),
+                 histo->GetEntries());
+}
+
+TH1F *flatTemplateHisto(const FlatTemplate &t, const char *name) {
+  if(!name) name = t.name;
+  const int nb = t.nbins;
+
+  // a fixed-width axis if the edges are the ones TAxis computes for it
+  const double step = (t.edges[nb] - t.edges[0])/nb;
+  bool uniform = true;
+  for(int i=1; i<nb && uniform; i++) uniform = (t.edges[i] == t.edges[0] + i*step);
+
+  TH1F *histo = (uniform ? new TH1F(name, name, nb, t.edges[0], t.edges[nb])
+                         : new TH1F(name, name, nb, t.edges));
+  histo->SetDirectory(0);
+  if(t.sumw2) histo->Sumw2();
+  for(int i=0; i<=nb+1; i++) {
+    histo->SetBinContent(i, t.contents[i]);
+    if(t.sumw2) histo->GetSumw2()->SetAt(t.sumw2[i], i);
+  }
+  histo->SetEntries(t.entries);
+  RUNSTATS_COUNT(kObjectReads, 1);
+  return histo;
+}
@@ -0,0 +1,259 @@
+#include "../interface/FlatTemplates.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kFlatMagic[8] = { 'M', 'L', 'B', 'W', 'F', 'L', 'A', 'T' };
+
+static uint64_t flatAlign(uint64_t offset) {
+  return (offset + kFlatAlign - 1)/kFlatAlign*kFlatAlign;
+}
+
+FlatTemplateWriter::FlatTemplateWriter()
+{
+}
+
+bool FlatTemplateWriter::splitName(const std::string &name, std::string &process,
+                                   std::string &channel, double &width) {
+  const std::string prefix = "mlbwa__";
+  if(name.compare(0, prefix.size(), prefix) != 0) return false;
+
+  // the process names have no underscores, the channels may
+  std::string::size_type end = name.find('_', prefix.size());
+  if(end == std::string::npos || end == prefix.size() || end+1 == name.size()) return false;
+  process = name.substr(prefix.size(), end - prefix.size());
+  channel = name.substr(end+1);
+
+  // a width is a number followed by another underscore
+  width = -1;
+  std::string::size_type next = channel.find('_');
+  if(next != std::string::npos && next > 0 && next+1 < channel.size()) {
+    const char *first = channel.c_str();
+    char *last = 0;
+    double value = strtod(first, &last);
+    if(last == first+next) {
+      width = value;
+      channel = channel.substr(next+1);
+    }
+  }
+  return true;
+}
+
+bool FlatTemplateWriter::add(const std::string &name, int nbins, const double *edges,
+                             const double *contents, const double *sumw2, double entries) {
+  Item item;
+  if(nbins <= 0 || lookup_.count(name) || !splitName(name, item.process, item.channel, item.width)) {
+    return false;
+  }
+
+  item.name    = name;
+  item.nbins   = nbins;
+  item.entries = entries;
+  item.edges.assign(edges, edges+nbins+1);
+  item.contents.assign(contents, contents+nbins+2);
+  if(sumw2) item.sumw2.assign(sumw2, sumw2+nbins+2);
+
+  lookup_[name] = items_.size();
+  items_.push_back(item);
+  return true;
+}
+
+long long FlatTemplateWriter::write(const char *fileName) const {
+  // the index order, the one find() searches
+  std::vector<int> order(items_.size());
+  for(unsigned int i=0; i<order.size(); i++) order[i] = i;
+  std::sort(order.begin(), order.end(), [this](int a, int b) {
+    const Item &x = items_[a], &y = items_[b];
+    if(x.process != y.process) return x.process < y.process;
+    if(x.channel != y.channel) return x.channel < y.channel;
+    return x.width < y.width;
+  });
+
+  std::string strings;
+  std::vector<FlatTemplateEntry> index(items_.size());
+  FlatTemplateHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kFlatMagic, sizeof(header.magic));
+  header.version       = kFlatVersion;
+  header.byteOrder     = kFlatByteOrder;
+  header.count         = items_.size();
+  header.indexOffset   = flatAlign(sizeof(header));
+
+  for(unsigned int i=0; i<order.size(); i++) {
+    const Item &item = items_[order[i]];
+    FlatTemplateEntry &entry = index[i];
+    memset(&entry, 0, sizeof(entry));
+    entry.name    = strings.size(); strings += item.name;    strings += '\0';
+    entry.process = strings.size(); strings += item.process; strings += '\0';
+    entry.channel = strings.size(); strings += item.channel; strings += '\0';
+    entry.nbins   = item.nbins;
+    entry.width   = item.width;
+    entry.entries = item.entries;
+  }
+  header.stringsOffset = flatAlign(header.indexOffset + index.size()*sizeof(FlatTemplateEntry));
+  header.stringsSize   = strings.size();
+  header.dataOffset    = flatAlign(header.stringsOffset + strings.size());
+
+  uint64_t offset = header.dataOffset;
+  for(unsigned int i=0; i<order.size(); i++) {
+    const Item &item = items_[order[i]];
+    FlatTemplateEntry &entry = index[i];
+    entry.edges    = offset; offset = flatAlign(offset + item.edges.size()*sizeof(double));
+    entry.contents = offset; offset = flatAlign(offset + item.contents.size()*sizeof(double));
+    if(!item.sumw2.empty()) {
+      entry.sumw2  = offset; offset = flatAlign(offset + item.sumw2.size()*sizeof(double));
+    }
+  }
+  header.fileSize = offset;
+
+  // the whole file in memory, then written in one go
+  std::vector<char> buffer(header.fileSize, 0);
+  memcpy(&buffer[0], &header, sizeof(header));
+  if(!index.empty()) {
+    memcpy(&buffer[header.indexOffset], &index[0], index.size()*sizeof(FlatTemplateEntry));
+  }
+  if(!strings.empty()) memcpy(&buffer[header.stringsOffset], strings.data(), strings.size());
+  for(unsigned int i=0; i<order.size(); i++) {
+    const Item &item = items_[order[i]];
+    const FlatTemplateEntry &entry = index[i];
+    memcpy(&buffer[entry.edges], &item.edges[0], item.edges.size()*sizeof(double));
+    memcpy(&buffer[entry.contents], &item.contents[0], item.contents.size()*sizeof(double));
+    if(entry.sumw2) memcpy(&buffer[entry.sumw2], &item.sumw2[0], item.sumw2.size()*sizeof(double));
+  }
+
+  // readers never see a half-written file
+  std::string temporary = std::string(fileName) + ".tmp";
+  FILE *out = fopen(temporary.c_str(), "wb");
+  if(!out) return -1;
+  bool ok = (fwrite(&buffer[0], 1, buffer.size(), out) == buffer.size());
+  ok = (fclose(out) == 0) && ok;
+  if(!ok || rename(temporary.c_str(), fileName) != 0) {
+    remove(temporary.c_str());
+    return -1;
+  }
+  return header.fileSize;
+}
+
+FlatTemplateFile::FlatTemplateFile()
+  : map_(0), mapSize_(0)
+{
+}
+
+FlatTemplateFile::~FlatTemplateFile() {
+  close();
+}
+
+void FlatTemplateFile::close() {
+  if(map_) munmap(map_, mapSize_);
+  map_ = 0;
+  mapSize_ = 0;
+  templates_.clear();
+  names_.clear();
+}
+
+bool FlatTemplateFile::fail(const std::string &message) {
+  close();
+  error_ = message;
+  return false;
+}
+
+bool FlatTemplateFile::open(const char *fileName) {
+  close();
+  error_.clear();
+
+  int fd = ::open(fileName, O_RDONLY);
+  if(fd < 0) return fail(std::string("could not open ") + fileName);
+  struct stat st;
+  if(fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(FlatTemplateHeader)) {
+    ::close(fd);
+    return fail(std::string(fileName) + " is too short for a template file");
+  }
+
+  void *mapped = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if(mapped == MAP_FAILED) return fail(std::string("could not map ") + fileName);
+  map_ = mapped;
+  mapSize_ = st.st_size;
+
+  const char *base = (const char*) map_;
+  const FlatTemplateHeader &header = *(const FlatTemplateHeader*) base;
+  if(memcmp(header.magic, kFlatMagic, sizeof(header.magic)) != 0) {
+    return fail(std::string(fileName) + " is not a template file");
+  }
+  if(header.byteOrder != kFlatByteOrder) {
+    return fail(std::string(fileName) + " was written with the other byte order");
+  }
+  if(header.version != kFlatVersion) {
+    return fail(std::string(fileName) + " has an unknown version");
+  }
+
+  const uint64_t size = mapSize_;
+  if(header.fileSize != size
+     || header.indexOffset % 8 != 0 || header.indexOffset > size
+     || header.count > (size - header.indexOffset)/sizeof(FlatTemplateEntry)
+     || header.stringsOffset > size || header.stringsSize > size - header.stringsOffset
+     || (header.stringsSize > 0 && base[header.stringsOffset + header.stringsSize - 1] != '\0')) {
+    return fail(std::string(fileName) + " is truncated or corrupt");
+  }
+
+  // every array has to lie inside the file, on a double boundary
+  const FlatTemplateEntry *index = (const FlatTemplateEntry*) (base + header.indexOffset);
+  const char *strings = base + header.stringsOffset;
+  templates_.resize(header.count);
+  for(uint64_t i=0; i<header.count; i++) {
+    const FlatTemplateEntry &entry = index[i];
+    const uint64_t nb = entry.nbins;
+    bool ok = (nb > 0 && nb < size/sizeof(double)
+               && entry.name < header.stringsSize && entry.process < header.stringsSize
+               && entry.channel < header.stringsSize);
+    const uint64_t arrays[3] = { entry.edges, entry.contents, entry.sumw2 };
+    const uint64_t lengths[3] = { nb+1, nb+2, nb+2 };
+    for(int k=0; k<3 && ok; k++) {
+      if(k == 2 && arrays[k] == 0) continue;
+      ok = (arrays[k] % 8 == 0 && arrays[k] >= header.dataOffset && arrays[k] <= size
+            && lengths[k] <= (size - arrays[k])/sizeof(double));
+    }
+    if(!ok) return fail(std::string(fileName) + " is truncated or corrupt");
+
+    FlatTemplate &t = templates_[i];
+    t.name     = strings + entry.name;
+    t.process  = strings + entry.process;
+    t.channel  = strings + entry.channel;
+    t.width    = entry.width;
+    t.nbins    = nb;
+    t.entries  = entry.entries;
+    t.edges    = (const double*) (base + entry.edges);
+    t.contents = (const double*) (base + entry.contents);
+    t.sumw2    = (entry.sumw2 ? (const double*) (base + entry.sumw2) : 0);
+    names_[t.name] = i;
+  }
+  return true;
+}
+
+const FlatTemplate *FlatTemplateFile::find(const char *name) const {
+  std::unordered_map<std::string, int>::const_iterator found = names_.find(name);
+  return (found == names_.end() ? 0 : &templates_[found->second]);
+}
+
+const FlatTemplate *FlatTemplateFile::find(const char *process, const char *channel, double width) const {
+  // the index is sorted by process, channel and width
+  std::vector<FlatTemplate>::const_iterator it = std::lower_bound(templates_.begin(), templates_.end(),
+      0, [&](const FlatTemplate &t, int) {
+        int c = strcmp(t.process, process);
+        if(c == 0) c = strcmp(t.channel, channel);
+        return (c < 0 || (c == 0 && t.width < width - 1e-6));
+      });
+  if(it == templates_.end() || strcmp(it->process, process) != 0 || strcmp(it->channel, channel) != 0
+     || std::fabs(it->width - width) > 1e-6) {
+    return 0;
+  }
+  return &*it;
+}
@@ -0,0 +1,156 @@
+#include "../interface/GofTest.h"
+#include "../interface/ThreadPool.h"
+
+#include "TMath.h"
+#include "TRandom3.h"
+
+#include <cmath>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+GofTest::GofTest()
+  : dropped_(0)
+{
+}
+
+void GofTest::reset() {
+  expected_.clear();
+  variance_.clear();
+  observed_.clear();
+  dropped_ = 0;
+}
+
+void GofTest::addExpected(const TH1 *histo) {
+  const int nb = histo->GetNbinsX();
+  if(expected_.empty()) {
+    expected_.assign(nb, 0.);
+    variance_.assign(nb, 0.);
+  }
+  if(nb != nbins()) {
+    cout<<"WARNING: "<<histo->GetName()<<" has "<<nb<<" bins, the MC before it "<<nbins()
+        <<", not in the goodness of fit"<<endl;
+    dropped_++;
+    return;
+  }
+
+  for(int i=0; i<nb; i++) {
+    double error = histo->GetBinError(i+1);
+    expected_[i] += histo->GetBinContent(i+1);
+    variance_[i] += error*error;
+  }
+}
+
+void GofTest::setObserved(const TH1 *histo) {
+  const int nb = histo->GetNbinsX();
+  observed_.resize(nb);
+  for(int i=0; i<nb; i++) observed_[i] = histo->GetBinContent(i+1);
+}
+
+void GofTest::prepare() const {
+  const int nb = nbins();
+  double total = 0;
+  for(int i=0; i<nb; i++) total += expected_[i];
+
+  p_.resize(nb);
+  cdf_.resize(nb);
+  pVariance_.resize(nb);
+  double sum = 0;
+  for(int i=0; i<nb; i++) {
+    p_[i] = expected_[i]/total;
+    pVariance_[i] = variance_[i]/(total*total);
+    sum += p_[i];
+    cdf_[i] = sum;
+  }
+}
+
+void GofTest::statistics(const double *observed, double &ks, double &ad, double &chi2, int &ndf) const {
+  const int nb = nbins();
+  double n = 0;
+  for(int i=0; i<nb; i++) n += observed[i];
+
+  ks = ad = chi2 = 0;
+  ndf = -1;
+  if(n <= 0) return;
+
+  double sum = 0;
+  for(int i=0; i<nb; i++) {
+    sum += observed[i];
+    const double d = sum/n - cdf_[i];
+    if(std::fabs(d) > ks) ks = std::fabs(d);
+    if(cdf_[i] > 0 && cdf_[i] < 1) ad += p_[i]*d*d/(cdf_[i]*(1-cdf_[i]));
+
+    if(p_[i] > 0) {
+      const double mu = n*p_[i];
+      const double r = observed[i] - mu;
+      chi2 += r*r/(mu + n*n*pVariance_[i]);
+      ndf++;
+    }
+  }
+  ad *= n;
+}
+
+GofResult GofTest::test(int nToys, UInt_t seed, ThreadPool *pool) const {
+  GofResult result;
+  result.ok = false;
+  result.observed = result.expected = 0;
+  result.ks = result.ad = result.chi2 = 0;
+  result.ksProb = result.adProb = result.chi2Prob = -1;
+  result.ndf = 0;
+  result.toys = 0;
+  result.dropped = dropped_;
+
+  const int nb = nbins();
+  if(nb == 0 || (int) observed_.size() != nb || dropped_ > 0) return result;
+
+  double sumw2 = 0;
+  for(int i=0; i<nb; i++) {
+    result.observed += observed_[i];
+    result.expected += expected_[i];
+    sumw2 += variance_[i];
+  }
+  if(result.observed <= 0 || result.expected <= 0) return result;
+
+  prepare();
+  statistics(&observed_[0], result.ks, result.ad, result.chi2, result.ndf);
+  result.ok = true;
+
+  if(nToys <= 0) {
+    double nMC = (sumw2 > 0 ? result.expected*result.expected/sumw2 : result.expected);
+    double ne = result.observed*nMC/(result.observed + nMC);
+    result.ksProb = TMath::KolmogorovProb(result.ks*std::sqrt(ne));
+    if(result.ndf > 0) result.chi2Prob = TMath::Prob(result.chi2, result.ndf);
+    return result;
+  }
+
+  // how many toys of every block fit at least as badly, per statistic
+  const int nBlocks = (nToys + kToyBlock - 1)/kToyBlock;
+  std::vector<int> worse(3*nBlocks, 0);
+  const double n = result.observed;
+  auto block = [&](int b, int) {
+    TRandom3 rnd(seed + 7919*(b+1));
+    std::vector<double> toy(nb);
+    const int first = b*kToyBlock;
+    const int last = (first + kToyBlock < nToys ? first + kToyBlock : nToys);
+    for(int t=first; t<last; t++) {
+      for(int i=0; i<nb; i++) toy[i] = (p_[i] > 0 ? rnd.Poisson(n*p_[i]) : 0);
+      double ks, ad, chi2;
+      int ndf;
+      statistics(&toy[0], ks, ad, chi2, ndf);
+      if(ks >= result.ks) worse[3*b]++;
+      if(ad >= result.ad) worse[3*b+1]++;
+      if(chi2 >= result.chi2) worse[3*b+2]++;
+    }
+  };
+  if(pool) pool->run(nBlocks, block);
+  else for(int b=0; b<nBlocks; b++) block(b, 0);
+
+  int k[3] = { 0, 0, 0 };
+  for(int b=0; b<nBlocks; b++) for(int s=0; s<3; s++) k[s] += worse[3*b+s];
+  result.toys = nToys;
+  result.ksProb = (k[0] + 1.)/(nToys + 1.);
+  result.adProb = (k[1] + 1.)/(nToys + 1.);
+  result.chi2Prob = (k[2] + 1.)/(nToys + 1.);
+  return result;
+}
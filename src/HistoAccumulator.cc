@@ -0,0 +1,98 @@
+#include "../interface/HistoAccumulator.h"
+#include "../interface/FlatTemplateHisto.h"
+#include "../interface/RunStats.h"
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TSystem.h"
+
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+HistoAccumulator::HistoAccumulator()
+{
+}
+
+HistoAccumulator::~HistoAccumulator() {
+  for(unsigned int i=0; i<histos_.size(); i++) delete histos_[i].second;
+}
+
+bool HistoAccumulator::add(const TString &name, const TH1 *histo) {
+  TH1 *existing = get(name);
+  if(existing) {
+    existing->Add(histo);
+    return true;
+  }
+
+  TH1 *copy = (TH1*) histo->Clone(name);
+  RUNSTATS_COUNT(kHistoClones, 1);
+  return adopt(name, copy);
+}
+
+bool HistoAccumulator::adopt(const TString &name, TH1 *histo) {
+  std::unordered_map<std::string, int>::const_iterator found = lookup_.find(name.Data());
+  if(found != lookup_.end()) {
+    histos_[found->second].second->Add(histo);
+    delete histo;
+    return true;
+  }
+
+  // kept out of any directory, the output file only exists in write()
+  histo->SetDirectory(0);
+  histo->SetName(name);
+  lookup_[name.Data()] = histos_.size();
+  histos_.push_back(std::make_pair(name, histo));
+  return false;
+}
+
+bool HistoAccumulator::adoptUnique(const TString &name, TH1 *histo) {
+  if(lookup_.count(name.Data())) {
+    cout<<"ERROR: "<<name<<" is in the output already, not added to it"<<endl;
+    delete histo;
+    return false;
+  }
+  adopt(name, histo);
+  return true;
+}
+
+TH1 *HistoAccumulator::get(const TString &name) const {
+  std::unordered_map<std::string, int>::const_iterator found = lookup_.find(name.Data());
+  return (found == lookup_.end() ? 0 : histos_[found->second].second);
+}
+
+Long64_t HistoAccumulator::write(const char *fileName, int compression) {
+  TDirectory *previous = gDirectory;
+
+  TFile *output = new TFile(fileName, "RECREATE", "", compression);
+  if(!output || output->IsZombie()) {
+    cout<<"ERROR: could not create "<<fileName<<endl;
+    delete output;
+    if(previous) previous->cd();
+    return -1;
+  }
+
+  output->cd();
+  for(unsigned int i=0; i<histos_.size(); i++) {
+    histos_[i].second->Write(histos_[i].first);
+  }
+  output->Close();
+  delete output;
+  if(previous) previous->cd();
+
+  FileStat_t stat;
+  if(gSystem->GetPathInfo(fileName, stat) != 0) return -1;
+  return stat.fSize;
+}
+
+Long64_t HistoAccumulator::writeFlat(const char *fileName) const {
+  FlatTemplateWriter flat;
+  for(unsigned int i=0; i<histos_.size(); i++) {
+    if(!addFlatTemplate(flat, histos_[i].first, histos_[i].second)) {
+      cout<<"ERROR: "<<histos_[i].first<<" is not a template name, not in "<<fileName<<endl;
+      return -1;
+    }
+  }
+  return flat.write(fileName);
+}
@@ -0,0 +1,64 @@
+#include "../interface/HistoPool.h"
+#include "../interface/RunStats.h"
+
+#include "TDirectory.h"
+
+HistoPool::HistoPool(int nGroups)
+  : size_(0), peak_(0), bytes_(0), peakBytes_(0)
+{
+  setGroups(nGroups);
+}
+
+HistoPool::~HistoPool() {
+  clear();
+}
+
+void HistoPool::setGroups(int nGroups) {
+  clear();
+  groups_.assign(nGroups, std::vector<TH1*>());
+}
+
+Long64_t HistoPool::estimate(const TH1 *histo) {
+  return Long64_t(histo->GetNbinsX()+2)*2*sizeof(Double_t) + sizeof(*histo);
+}
+
+TH1 *HistoPool::adopt(int group, TH1 *histo) {
+  if(!histo) return 0;
+  histo->SetDirectory(0);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  groups_[group].push_back(histo);
+  size_++;
+  bytes_ += estimate(histo);
+  if(size_ > peak_) peak_ = size_;
+  if(bytes_ > peakBytes_) peakBytes_ = bytes_;
+  return histo;
+}
+
+void HistoPool::release(int group) {
+  std::vector<TH1*> &histos = groups_[group];
+  for(unsigned int i=0; i<histos.size(); i++) {
+    bytes_ -= estimate(histos[i]);
+    delete histos[i];
+  }
+  size_ -= histos.size();
+  // give the memory of the vector back as well
+  std::vector<TH1*>().swap(histos);
+}
+
+void HistoPool::clear() {
+  for(unsigned int i=0; i<groups_.size(); i++) release(i);
+}
+
+ScopedFile::ScopedFile(const char *fileName, Option_t *option)
+{
+  TDirectory *previous = gDirectory;
+  file_ = new TFile(fileName, option);
+  RUNSTATS_COUNT(kFileOpens, 1);
+  if(previous) previous->cd();
+}
+
+ScopedFile::~ScopedFile() {
+  if(file_ && file_->IsOpen()) file_->Close();
+  delete file_;
+}
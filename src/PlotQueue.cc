@@ -0,0 +1,105 @@
+#include "../interface/PlotQueue.h"
+
+#include "TObjArray.h"
+#include "TObjString.h"
+#include "TROOT.h"
+#include "TStyle.h"
+
+#include <cstdio>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+PlotQueue::PlotQueue()
+  : child_(-1), counter_(0)
+{
+}
+
+PlotQueue::~PlotQueue() {
+  wait();
+  for(unsigned int i=0; i<entries_.size(); i++) delete entries_[i].canvas;
+}
+
+void PlotQueue::add(TCanvas *canvas, const TString &baseName, const TString &formats) {
+  canvas->Update();
+
+  // a name of its own, a new canvas with the old name would delete it
+  Entry entry;
+  entry.canvas = (TCanvas*) canvas->Clone(TString::Format("%s_queued%d", canvas->GetName(), counter_++));
+  entry.baseName = baseName;
+  entry.formats = formats;
+  entry.optStat = gStyle->GetOptStat();
+  entry.optFit = gStyle->GetOptFit();
+  entries_.push_back(entry);
+}
+
+int PlotQueue::render(const Entry &entry) {
+  gStyle->SetOptStat(entry.optStat);
+  gStyle->SetOptFit(entry.optFit);
+  entry.canvas->Draw();
+
+  int files = 0;
+  TObjArray *formats = entry.formats.Tokenize(" ");
+  for(int i=0; i<formats->GetEntries(); i++) {
+    const TString &format = ((TObjString*) formats->At(i))->GetString();
+    entry.canvas->Print(entry.baseName+"."+format);
+    files++;
+  }
+  delete formats;
+  return files;
+}
+
+int PlotQueue::flush(bool background) {
+  wait();
+  if(entries_.empty()) return 0;
+
+  int files = 0;
+  for(unsigned int i=0; i<entries_.size(); i++) {
+    TObjArray *formats = entries_[i].formats.Tokenize(" ");
+    files += formats->GetEntries();
+    delete formats;
+  }
+
+  // no display to share with a child outside batch mode
+  pid_t pid = -1;
+  if(background && gROOT->IsBatch()) {
+    fflush(stdout);
+    cout.flush();
+    pid = fork();
+    if(pid == 0) {
+      for(unsigned int i=0; i<entries_.size(); i++) render(entries_[i]);
+      fflush(stdout);
+      cout.flush();
+      _exit(0);
+    }
+    if(pid < 0) cout<<"WARNING: could not fork, the plots are written here"<<endl;
+  }
+
+  int optStat = gStyle->GetOptStat(), optFit = gStyle->GetOptFit();
+  for(unsigned int i=0; i<entries_.size(); i++) {
+    if(pid < 0) render(entries_[i]);
+    delete entries_[i].canvas;
+  }
+  gStyle->SetOptStat(optStat);
+  gStyle->SetOptFit(optFit);
+  entries_.clear();
+
+  child_ = pid;
+  return files;
+}
+
+bool PlotQueue::wait() {
+  if(child_ <= 0) return true;
+
+  int status = 0;
+  pid_t done = waitpid(child_, &status, 0);
+  child_ = -1;
+  if(done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    cout<<"ERROR: the plot writer failed, status "<<status<<endl;
+    return false;
+  }
+  return true;
+}
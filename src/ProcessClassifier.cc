@@ -0,0 +1,116 @@
+#include "../interface/ProcessClassifier.h"
+#include "../interface/RunStats.h"
+
+#include <cstdio>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+//Returns the n-th non-empty token of str split on delim (as TString::Tokenize
+//would, without allocating a TObjArray), or "" if there are not enough tokens
+static std::string nthToken(const std::string &str, char delim, int n) {
+  std::string::size_type start = 0;
+  while(start < str.size()) {
+    std::string::size_type end = str.find(delim, start);
+    if(end == std::string::npos) end = str.size();
+    if(end > start) {
+      if(n == 0) return str.substr(start, end-start);
+      n--;
+    }
+    start = end+1;
+  }
+  return std::string();
+}
+
+ProcessClassifier::ProcessClassifier(const char* const* procs, const char* const* procReplace,
+                                     int nProcs, const char* const* signalNames, int nSignals)
+  : procReplace_(procReplace), signalNames_(signalNames), nProcs_(nProcs), nSignals_(nSignals)
+{
+  // compile the process patterns once
+  for(int j=0; j<nProcs_; j++) {
+    patterns_.push_back(new TRegexp(procs[j]));
+  }
+}
+
+ProcessClassifier::~ProcessClassifier() {
+  for(unsigned int j=0; j<patterns_.size(); j++) delete patterns_[j];
+}
+
+const ProcessInfo& ProcessClassifier::classify(const char* histoName) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return classifyLocked(histoName);
+}
+
+const ProcessInfo& ProcessClassifier::classifyLocked(const char* histoName) {
+  std::map<std::string, ProcessInfo>::const_iterator found = infos_.find(histoName);
+  if(found != infos_.end()) return found->second;
+
+  // <sample>_<process>_..._mlbwa_<lep>_<histogram>
+  std::string name(histoName);
+  std::string::size_type sep = name.find("_mlbwa_");
+  std::string procPart = name.substr(0, sep);
+  std::string histPart = (sep == std::string::npos ? std::string() : name.substr(sep+7));
+
+  ProcessInfo info;
+  info.proc     = -1;
+  info.isData   = (nthToken(procPart, '_', 0).find("Data") != std::string::npos);
+  info.isSignal = false;
+  info.process  = nthToken(procPart, '_', 1).c_str();
+  info.lepton   = nthToken(histPart.substr(0, histPart.find("_mlbwa_")), '_', 0).c_str();
+
+  // if data, just say data
+  if(info.isData) info.process = "Data";
+  else {
+    TString delimited = TString("_") + info.process;
+    for(int pInd = 0; pInd<nProcs_; pInd++) {
+      if(!delimited.Contains(*patterns_[pInd])) continue;
+
+      info.proc    = pInd;
+      info.process = procReplace_[pInd];
+      for(int sigCheck=0; sigCheck<nSignals_; sigCheck++) {
+        if(info.process == signalNames_[sigCheck]) {
+          info.isSignal = true;
+          break;
+        }
+      }
+      break;
+    }
+  }
+
+  RUNSTATS_LOG(kDebug)<<" - classified "<<histoName<<" as "<<info.process<<" ("<<info.lepton<<")"
+      <<(info.isSignal ? ", signal" : "")<<endl;
+
+  return infos_.insert(std::make_pair(name, info)).first->second;
+}
+
+TString ProcessClassifier::formatName(const char* histoName, double signalWidth) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const ProcessInfo &info = classifyLocked(histoName);
+  lock.unlock();
+
+  // mlbwa__<Process>_<E/EE/EM/MM/M>, signals get the width (mlbwa__TTbar_7.50_E)
+  TString proces = info.process;
+  if(info.isSignal) {
+    char wid[32];
+    sprintf(wid, "_%.2f", signalWidth);
+    proces += wid;
+  }
+
+  return TString("mlbwa__")+proces+TString("_")+info.lepton;
+}
+
+UInt_t ProcessClassifier::matchMask(const char* keyName) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<std::string, UInt_t>::const_iterator found = masks_.find(keyName);
+  if(found != masks_.end()) return found->second;
+
+  UInt_t mask = 0;
+  TString name(keyName);
+  for(int j=0; j<nProcs_; j++) {
+    if(name.Contains(*patterns_[j])) mask |= (1u << j);
+  }
+
+  masks_[keyName] = mask;
+  return mask;
+}
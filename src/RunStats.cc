@@ -0,0 +1,135 @@
+#include "../interface/RunStats.h"
+
+#include "TFile.h"
+#include "TSystem.h"
+
+#include <sys/resource.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+using std::cout;
+using std::endl;
+
+static const char *counterNames[RunStats::kCounters] = {
+  "file_opens", "object_reads", "histo_clones", "morphs", "fits",
+  "fcn_calls", "toys", "toy_retries", "template_loads", "template_evictions"
+};
+
+RunStats::RunStats()
+  : level_(kInfo), start_(std::chrono::steady_clock::now()), atExit_(false)
+{
+  for(int c=0; c<kCounters; c++) counters_[c] = 0;
+
+  const char *report = gSystem->Getenv("RUNSTATS_REPORT");
+  if(report) setReport(report);
+}
+
+const char *RunStats::counterName(Counter c) {
+  return counterNames[c];
+}
+
+Long64_t RunStats::peakRss(bool children) {
+  struct rusage usage;
+  if(getrusage(children ? RUSAGE_CHILDREN : RUSAGE_SELF, &usage) != 0) return 0;
+  return usage.ru_maxrss;   // kB on Linux
+}
+
+void RunStats::addTime(const char *name, double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for(unsigned int i=0; i<timers_.size(); i++) {
+    if(timers_[i].first == name) {
+      timers_[i].second.calls++;
+      timers_[i].second.seconds += seconds;
+      return;
+    }
+  }
+  Timer timer = { 1, seconds };
+  timers_.push_back(std::make_pair(std::string(name), timer));
+}
+
+void RunStats::setReport(const char *fileName) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  report_ = fileName;
+  if(!atExit_ && !report_.empty()) {
+    atexit(&RunStats::reportAtExit);
+    atExit_ = true;
+  }
+}
+
+void RunStats::reportAtExit() {
+  RunStats &stats = instance();
+  std::string report;
+  {
+    std::lock_guard<std::mutex> lock(stats.mutex_);
+    report = stats.report_;
+  }
+  if(!report.empty()) stats.writeReport(report.c_str());
+}
+
+bool RunStats::writeReport(const char *fileName) const {
+  std::ofstream out(fileName);
+  if(!out) {
+    cout<<"ERROR: could not write the run report "<<fileName<<endl;
+    return false;
+  }
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  Long64_t bytesRead = TFile::GetFileBytesRead();
+  Long64_t rss = peakRss(), childRss = peakRss(true);
+  std::lock_guard<std::mutex> lock(mutex_);
+  out<<std::setprecision(9);
+
+  if(TString(fileName).EndsWith(".csv")) {
+    out<<"kind,name,count,seconds\n";
+    out<<"run,wall,,"<<wall<<"\n";
+    out<<"counter,bytes_read,"<<bytesRead<<",\n";
+    out<<"memory,peak_rss_kb,"<<rss<<",\n";
+    out<<"memory,peak_child_rss_kb,"<<childRss<<",\n";
+    for(int c=0; c<kCounters; c++) {
+      out<<"counter,"<<counterNames[c]<<","<<counter((Counter) c)<<",\n";
+    }
+    for(unsigned int i=0; i<timers_.size(); i++) {
+      out<<"timer,"<<timers_[i].first<<","<<timers_[i].second.calls<<","
+         <<timers_[i].second.seconds<<"\n";
+    }
+  } else {
+    out<<"{\n  \"wall_seconds\": "<<wall<<",\n  \"peak_rss_kb\": "<<rss
+       <<",\n  \"peak_child_rss_kb\": "<<childRss<<",\n  \"counters\": {\n"
+       <<"    \"bytes_read\": "<<bytesRead;
+    for(int c=0; c<kCounters; c++) {
+      out<<",\n    \""<<counterNames[c]<<"\": "<<counter((Counter) c);
+    }
+    out<<"\n  },\n  \"timers\": {";
+    for(unsigned int i=0; i<timers_.size(); i++) {
+      out<<(i ? "," : "")<<"\n    \""<<timers_[i].first<<"\": { \"calls\": "
+         <<timers_[i].second.calls<<", \"seconds\": "<<timers_[i].second.seconds<<" }";
+    }
+    out<<"\n  }\n}\n";
+  }
+  return true;
+}
+
+void RunStats::print() const {
+  cout<<"Run statistics:"<<endl;
+  cout<<" - "<<std::setw(16)<<std::left<<"bytes_read"<<std::right<<std::setw(14)
+      <<TFile::GetFileBytesRead()<<endl;
+  cout<<" - "<<std::setw(16)<<std::left<<"peak_rss_kb"<<std::right<<std::setw(14)
+      <<peakRss()<<endl;
+  if(peakRss(true) > 0) {
+    cout<<" - "<<std::setw(16)<<std::left<<"peak_child_rss"<<std::right<<std::setw(14)
+        <<peakRss(true)<<endl;
+  }
+  for(int c=0; c<kCounters; c++) {
+    cout<<" - "<<std::setw(16)<<std::left<<counterNames[c]<<std::right<<std::setw(14)
+        <<counter((Counter) c)<<endl;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for(unsigned int i=0; i<timers_.size(); i++) {
+    cout<<" - "<<std::setw(16)<<std::left<<timers_[i].first<<std::right<<std::setw(14)
+        <<timers_[i].second.calls<<" calls "<<TString::Format("%10.3f", timers_[i].second.seconds)
+        <<" s"<<endl;
+  }
+}
@@ -0,0 +1,85 @@
+#include "../interface/TemplateCache.h"
+#include "../interface/RunStats.h"
+
+TemplateCache::TemplateCache(Long64_t maxBytes)
+  : maxBytes_(maxBytes), bytes_(0), peakBytes_(0), loads_(0), evictions_(0)
+{
+}
+
+TemplateCache::~TemplateCache() {
+  clear();
+}
+
+void TemplateCache::setMaxBytes(Long64_t maxBytes) {
+  maxBytes_ = maxBytes;
+  shrink(uses_.empty() ? std::string() : uses_.front());
+}
+
+TH1 *TemplateCache::get(const std::string &key) {
+  std::unordered_map<std::string, Entry>::iterator found = entries_.find(key);
+  if(found != entries_.end()) {
+    uses_.splice(uses_.begin(), uses_, found->second.use);
+    return found->second.histo;
+  }
+
+  TH1 *histo = (loader_ ? loader_(key) : 0);
+  if(!histo) return 0;
+  loads_++;
+  RUNSTATS_COUNT(kTemplateLoads, 1);
+
+  Entry entry;
+  entry.histo = histo;
+  entry.bytes = Long64_t(histo->GetNbinsX()+2)*2*sizeof(Double_t) + sizeof(*histo);
+  uses_.push_front(key);
+  entry.use = uses_.begin();
+  entries_[key] = entry;
+  bytes_ += entry.bytes;
+  if(bytes_ > peakBytes_) peakBytes_ = bytes_;
+  shrink(key);
+  return histo;
+}
+
+void TemplateCache::attach(const std::string &key, TObject *object, Long64_t bytes) {
+  std::unordered_map<std::string, Entry>::iterator found = entries_.find(key);
+  if(found == entries_.end()) {
+    delete object;
+    return;
+  }
+  found->second.attached.push_back(object);
+  found->second.bytes += bytes;
+  bytes_ += bytes;
+  if(bytes_ > peakBytes_) peakBytes_ = bytes_;
+  shrink(key);
+}
+
+const std::vector<TObject*> &TemplateCache::attached(const std::string &key) const {
+  static const std::vector<TObject*> none;
+  std::unordered_map<std::string, Entry>::const_iterator found = entries_.find(key);
+  return (found == entries_.end() ? none : found->second.attached);
+}
+
+void TemplateCache::clear() {
+  while(!entries_.empty()) drop(entries_.begin());
+}
+
+void TemplateCache::drop(std::unordered_map<std::string, Entry>::iterator entry) {
+  if(evicted_) evicted_(entry->first);
+  // what was built from the histogram goes first
+  std::vector<TObject*> &attached = entry->second.attached;
+  for(int i=attached.size()-1; i>=0; i--) delete attached[i];
+  delete entry->second.histo;
+  bytes_ -= entry->second.bytes;
+  uses_.erase(entry->second.use);
+  entries_.erase(entry);
+}
+
+void TemplateCache::shrink(const std::string &keep) {
+  if(maxBytes_ <= 0) return;
+  while(bytes_ > maxBytes_ && !uses_.empty()) {
+    const std::string &oldest = uses_.back();
+    if(oldest == keep) break;
+    drop(entries_.find(oldest));
+    evictions_++;
+    RUNSTATS_COUNT(kTemplateEvictions, 1);
+  }
+}
@@ -0,0 +1,97 @@
+#include "../interface/TemplateStore.h"
+
+#include "TAxis.h"
+
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+TemplateStore::TemplateStore()
+{
+  reset(0, 0., 0.);
+}
+
+void TemplateStore::reset(int nChannels, double lower, double upper) {
+  nChannels_ = nChannels;
+  lower_ = lower;
+  upper_ = upper;
+  for(int c=0; c<kComponents; c++) count_[c] = 1;
+  contents_.clear();
+  layout();
+}
+
+void TemplateStore::setCount(Component c, int count) {
+  if(!contents_.empty()) {
+    cout<<"ERROR: TemplateStore::setCount after set(), the store is cleared"<<endl;
+    contents_.clear();
+  }
+  count_[c] = count;
+  layout();
+}
+
+void TemplateStore::layout() {
+  int slots = 0;
+  for(int c=0; c<kComponents; c++) {
+    first_[c] = slots;
+    slots += nChannels_*count_[c];
+  }
+  histos_.assign(slots, (TH1*) 0);
+  offset_.assign(slots, 0);
+  nbins_.assign(slots, 0);
+  integral_.assign(slots, 0.);
+  window_.assign(slots, 0.);
+}
+
+bool TemplateStore::has(Component c, int channel, int index) const {
+  return (channel >= 0 && channel < nChannels_ && index >= 0 && index < count_[c]
+          && histos_[slot(c, channel, index)] != 0);
+}
+
+void TemplateStore::set(Component c, int channel, int index, TH1 *histo) {
+  if(!histo) return;
+  if(channel < 0 || channel >= nChannels_ || index < 0 || index >= count_[c]) {
+    cout<<"ERROR: TemplateStore has no channel "<<channel<<", template "<<index
+        <<" for component "<<c<<endl;
+    return;
+  }
+
+  const int s = slot(c, channel, index);
+  const int nb = histo->GetNbinsX();
+  histos_[s] = histo;
+  if(nbins_[s] != nb) {
+    // a new slot, or a new binning: the contents go to the end
+    nbins_[s] = nb;
+    offset_[s] = contents_.size();
+    contents_.resize(contents_.size() + nb+2);
+  }
+  double *bins = &contents_[offset_[s]];
+  for(int i=0; i<=nb+1; i++) bins[i] = histo->GetBinContent(i);
+
+  integral_[s] = sum(s, 1, nb);
+  TAxis *axis = histo->GetXaxis();
+  window_[s] = sum(s, axis->FindFixBin(lower_), axis->FindFixBin(upper_));
+}
+
+void TemplateStore::release(Component c, int channel, int index) {
+  if(channel < 0 || channel >= nChannels_ || index < 0 || index >= count_[c]) return;
+  histos_[slot(c, channel, index)] = 0;
+}
+
+double TemplateStore::integral(Component c, int channel, int index, double lower, double upper) const {
+  const int s = slot(c, channel, index);
+  TAxis *axis = histos_[s]->GetXaxis();
+  return sum(s, axis->FindFixBin(lower), axis->FindFixBin(upper));
+}
+
+double TemplateStore::sum(int s, int binLow, int binHigh) const {
+  // the bin range the way TH1::Integral(binx1, binx2) clips it
+  const int nb = nbins_[s];
+  if(binLow < 0) binLow = 0;
+  if(binHigh >= nb+2 || binHigh < binLow) binHigh = nb+1;
+
+  const double *bins = &contents_[offset_[s]];
+  double total = 0;
+  for(int i=binLow; i<=binHigh; i++) total += bins[i];
+  return total;
+}
@@ -0,0 +1,78 @@
+#include "../interface/ThreadPool.h"
+
+ThreadPool::ThreadPool(int nThreads)
+  : job_(0), nTasks_(0), nextTask_(0), nDone_(0), generation_(0), stop_(false)
+{
+  if(nThreads <= 1) return;
+  for(int i=0; i<nThreads; i++) {
+    threads_.push_back(std::thread(&ThreadPool::work, this, i));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for(unsigned int i=0; i<threads_.size(); i++) threads_[i].join();
+}
+
+void ThreadPool::run(int nTasks, const std::function<void(int,int)> &fn) {
+  // serial pool: just run everything here, in order
+  if(threads_.empty()) {
+    for(int task=0; task<nTasks; task++) fn(task, 0);
+    return;
+  }
+  if(nTasks <= 0) return;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  job_      = &fn;
+  nTasks_   = nTasks;
+  nextTask_ = 0;
+  nDone_    = 0;
+  ++generation_;
+  wake_.notify_all();
+
+  done_.wait(lock, [this] { return nDone_ == nTasks_; });
+  job_ = 0;
+
+  std::exception_ptr error = error_;
+  error_ = std::exception_ptr();
+  if(error) std::rethrow_exception(error);
+}
+
+void ThreadPool::work(int worker) {
+  unsigned long seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while(true) {
+    wake_.wait(lock, [this, &seen] { return stop_ || generation_ != seen; });
+    if(stop_) return;
+    seen = generation_;
+
+    // grab tasks until this job runs out of them
+    while(job_ && nextTask_ < nTasks_) {
+      int task = nextTask_++;
+      const std::function<void(int,int)> *job = job_;
+
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        (*job)(task, worker);
+      } catch(...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+
+      // a failed task ends the job: the tasks nobody took count as done
+      if(error) {
+        if(!error_) error_ = error;
+        nDone_ += nTasks_ - nextTask_;
+        nextTask_ = nTasks_;
+      }
+
+      if(++nDone_ == nTasks_) done_.notify_all();
+    }
+  }
+}
@@ -0,0 +1,46 @@
+#include "../interface/ToyPrecision.h"
+
+#include <cmath>
+
+ToyPrecision::ToyPrecision()
+{
+  reset();
+}
+
+void ToyPrecision::reset() {
+  n_ = 0;
+  biasMean_ = biasM2_ = 0;
+  pullMean_ = pullM2_ = 0;
+}
+
+void ToyPrecision::add(double bias, double pull) {
+  n_++;
+  double d = bias - biasMean_;
+  biasMean_ += d/n_;
+  biasM2_   += d*(bias - biasMean_);
+  d = pull - pullMean_;
+  pullMean_ += d/n_;
+  pullM2_   += d*(pull - pullMean_);
+}
+
+double ToyPrecision::biasError() const {
+  if(n_ < 2) return -1;
+  return std::sqrt(biasM2_/(n_-1)/n_);
+}
+
+double ToyPrecision::pullWidth() const {
+  if(n_ < 2) return -1;
+  return std::sqrt(pullM2_/(n_-1));
+}
+
+double ToyPrecision::pullWidthError() const {
+  if(n_ < 2) return -1;
+  return pullWidth()/std::sqrt(2.*(n_-1));
+}
+
+bool ToyPrecision::converged(double biasTarget, double pullWidthTarget, int minToys) const {
+  if(n_ < 2 || n_ < minToys) return false;
+  if(biasTarget > 0 && biasError() > biasTarget) return false;
+  if(pullWidthTarget > 0 && pullWidthError() > pullWidthTarget) return false;
+  return (biasTarget > 0 || pullWidthTarget > 0);
+}
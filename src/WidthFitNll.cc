@@ -0,0 +1,66 @@
+#include "../interface/WidthFitNll.h"
+
+#include <algorithm>
+
+WidthFitNll::WidthFitNll(BinnedTemplateNll &nll)
+  : nll_(nll), first_(1, 0), width_(0), shapesSet_(false)
+{
+}
+
+void WidthFitNll::addChannel(WidthTemplateGrid *grid, const std::vector<double> &low,
+                             const std::vector<double> &high) {
+  grids_.push_back(grid);
+  low_.push_back(low);
+  high_.push_back(high);
+  first_.push_back(first_.back() + low.size());
+  signal_.assign(first_.back(), 0.);
+  shapesSet_ = false;
+}
+
+const WidthFitNll::Projection &WidthFitNll::projection(int channel, int pair,
+                                                       const std::vector<double> &edges) const {
+  std::pair<int,int> key(channel, pair);
+  std::map<std::pair<int,int>, Projection>::iterator found = projections_.find(key);
+  if(found != projections_.end()) return found->second;
+
+  Projection &p = projections_[key];
+  const std::vector<double> &low = low_[channel], &high = high_[channel];
+  for(unsigned int t=0; t+1<edges.size(); t++) {
+    for(unsigned int r=0; r<low.size(); r++) {
+      double overlap = std::min(high[r], edges[t+1]) - std::max(low[r], edges[t]);
+      if(overlap <= 0) continue;
+      p.bin.push_back(t);
+      p.row.push_back(r);
+      p.fraction.push_back(overlap/(edges[t+1]-edges[t]));
+    }
+  }
+  return p;
+}
+
+void WidthFitNll::shapesAt(double width) const {
+  for(unsigned int c=0; c<grids_.size(); c++) {
+    std::pair<int,int> key(c, grids_[c]->bracket(width));
+    bool known = projections_.count(key);
+    grids_[c]->contentsAt(width, 1., contents_, known ? 0 : &edges_);
+    const Projection &p = projection(c, key.second, edges_);
+
+    double *signal = &signal_[first_[c]];
+    const int nrows = first_[c+1]-first_[c];
+    std::fill(signal, signal+nrows, 0.);
+    for(unsigned int k=0; k<p.bin.size(); k++) signal[p.row[k]] += contents_[p.bin[k]]*p.fraction[k];
+
+    // normalised within the data bins, as the RooHistPdf over the fit range
+    double sum = 0;
+    for(int r=0; r<nrows; r++) sum += signal[r];
+    if(sum > 0) for(int r=0; r<nrows; r++) signal[r] /= sum;
+  }
+
+  nll_.setSignal(&signal_[0]);
+  width_ = width;
+  shapesSet_ = true;
+}
+
+double WidthFitNll::operator()(const std::vector<double> &par) const {
+  if(!shapesSet_ || par[0] != width_) shapesAt(par[0]);
+  return nll_.value(&par[1]);
+}
@@ -0,0 +1,104 @@
+#include "../interface/WidthTemplateGrid.h"
+
+#include "TAxis.h"
+
+#include <algorithm>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+WidthTemplateGrid::WidthTemplateGrid()
+{
+}
+
+WidthTemplateGrid::~WidthTemplateGrid() {
+  for(unsigned int i=0; i<morphers_.size(); i++) delete morphers_[i];
+  for(unsigned int i=0; i<anchors_.size(); i++) delete anchors_[i];
+}
+
+void WidthTemplateGrid::addAnchor(double width, const TH1 *histo) {
+  // copy into a TH1D of the same binning, whatever the input type
+  const TAxis *axis = histo->GetXaxis();
+  const int nbins = axis->GetNbins();
+  std::vector<double> edges(nbins+1);
+  for(int i=1; i<=nbins; i++) edges[i-1] = axis->GetBinLowEdge(i);
+  edges[nbins] = axis->GetBinUpEdge(nbins);
+
+  TH1D *copy = new TH1D(TString::Format("%s_anchor_%.2f", histo->GetName(), width),
+                        histo->GetTitle(), nbins, &edges[0]);
+  copy->SetDirectory(0);
+  for(int i=0; i<=nbins+1; i++) {
+    copy->SetBinContent(i, histo->GetBinContent(i));
+    copy->SetBinError(i, histo->GetBinError(i));
+  }
+
+  // keep the anchors sorted, the pairs change so the morphers go
+  int pos = std::upper_bound(widths_.begin(), widths_.end(), width) - widths_.begin();
+  widths_.insert(widths_.begin()+pos, width);
+  anchors_.insert(anchors_.begin()+pos, copy);
+  integrals_.insert(integrals_.begin()+pos, copy->Integral());
+
+  for(unsigned int i=0; i<morphers_.size(); i++) delete morphers_[i];
+  morphers_.assign(widths_.size()-1, (TH1DMorpher*) 0);
+}
+
+bool WidthTemplateGrid::isValid() const {
+  if(widths_.size() < 2) {
+    cout<<"ERROR: a width grid needs at least two templates, it has "<<widths_.size()<<endl;
+    return false;
+  }
+  for(unsigned int i=0; i+1<widths_.size(); i++) {
+    if(widths_[i] == widths_[i+1]) {
+      cout<<"ERROR: two templates with width "<<widths_[i]<<" in the width grid"<<endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int WidthTemplateGrid::bracket(double width) const {
+  // first anchor above width, the pair is the one ending there
+  int above = std::upper_bound(widths_.begin(), widths_.end(), width) - widths_.begin();
+  return std::min(std::max(above-1, 0), (int) widths_.size()-2);
+}
+
+TH1DMorpher *WidthTemplateGrid::morpher(int pair) {
+  if(!morphers_[pair]) {
+    morphers_[pair] = new TH1DMorpher(anchors_[pair], anchors_[pair+1],
+                                      widths_[pair], widths_[pair+1]);
+  }
+  return morphers_[pair];
+}
+
+double WidthTemplateGrid::integralAt(double width) const {
+  int i = bracket(width);
+  return integrals_[i] + (integrals_[i+1]-integrals_[i])*(width-widths_[i])/(widths_[i+1]-widths_[i]);
+}
+
+TH1F *WidthTemplateGrid::templateAt(double width, const char *name, double norm) {
+  TH1DMorpher *m = morpher(bracket(width));
+  const std::vector<double> &contents = m->morphContents(width, (norm < 0 ? integralAt(width) : norm));
+
+  TH1F *templ = new TH1F(name, name, m->nbins(), m->edges());
+  templ->SetDirectory(0);
+  for(int i=0; i<m->nbins(); i++) templ->SetBinContent(i+1, contents[i]);
+  return templ;
+}
+
+std::vector<TH1F*> WidthTemplateGrid::templatesAt(const std::vector<double> &widths,
+                                                  const std::vector<TString> &names, double norm) {
+  std::vector<TH1F*> templates;
+  for(unsigned int k=0; k<widths.size() && k<names.size(); k++) {
+    templates.push_back(templateAt(widths[k], names[k], norm));
+  }
+  return templates;
+}
+
+int WidthTemplateGrid::contentsAt(double width, double norm, std::vector<double> &contents,
+                                  std::vector<double> *edges) {
+  TH1DMorpher *m = morpher(bracket(width));
+  contents = m->morphContents(width, (norm < 0 ? integralAt(width) : norm));
+  if(edges) edges->assign(m->edges(), m->edges()+m->nbins()+1);
+  return m->nbins();
+}
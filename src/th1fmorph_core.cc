@@ -0,0 +1,332 @@
+#include "../interface/th1fmorph_core.h"
+
+#include <algorithm>
+#include <cmath>
+
+int morphWeights(double par1, double par2, double parinterp, double &wt1, double &wt2) {
+  // ......The weights (wt1,wt2) are the complements of the "distances" between
+  //       the values of the parameters at the histograms and the desired
+  //       interpolation point. For example, wt1=0, wt2=1 means that the
+  //       interpolated histogram should be identical to input histogram 2.
+  //       If par1=par2 then we can choose any valid set of wt1,wt2 so why
+  //       not take the average?
+  if (par2 != par1) {
+    wt1 = 1. - (parinterp-par1)/(par2-par1);
+    wt2 = 1. + (parinterp-par2)/(par2-par1);
+  }
+  else {
+    wt1 = 0.5;
+    wt2 = 0.5;
+  }
+
+  if (wt1 < 0 || wt1 > 1. || wt2 < 0. || wt2 > 1. || fabs(1-(wt1+wt2)) > 1.0e-4) {
+    return kMorphExtrapolation;
+  }
+  return kMorphOk;
+}
+
+int morphMergeEdges(const double *edges1, int n1, const double *edges2, int n2, double *merged) {
+  // one pass over both sorted lists, equal edges are kept once (as the
+  // std::set this replaces did)
+  int n = 0, i = 0, j = 0;
+  while(i < n1 || j < n2) {
+    double edge;
+    if(j >= n2 || (i < n1 && edges1[i] < edges2[j])) edge = edges1[i++];
+    else if(i >= n1 || edges2[j] < edges1[i]) edge = edges2[j++];
+    else { edge = edges1[i++]; j++; }
+
+    if(n == 0 || merged[n-1] < edge) merged[n++] = edge;
+  }
+  return n;
+}
+
+double morphCdf(const double *contents, int nb, double *cdf) {
+  // the total is summed in bin order, as before, so the cdf's come out
+  // bit for bit the same
+  double total = 0;
+  for(int i=0; i<nb; i++) total += contents[i];
+
+  // normalise (independent bins, vectorises), then integrate
+  cdf[0] = 0;
+  for(int i=0; i<nb; i++) cdf[i+1] = contents[i]/total;
+  for(int i=1; i<=nb; i++) cdf[i] += cdf[i-1];
+
+  return total;
+}
+
+MorphCore::MorphCore()
+  : empty_(true), nb1_(0), nb2_(0), nbn_(0), nmax_(0), npts_(0),
+    edges1_(0), edges2_(0), cdf1_(0), cdf2_(0), bedgesn_(0), dx2_(0), x1_(0), x2_(0), y_(0)
+{
+}
+
+double *MorphCore::grow(std::vector<double> &buffer, int size) {
+  if((int) buffer.size() < size) buffer.resize(size);
+  return &buffer[0];
+}
+
+int MorphCore::set(const double *edges1, const double *contents1, int nb1,
+                   const double *edges2, const double *contents2, int nb2,
+                   const double *widths2)
+{
+  nb1_  = nb1;
+  nb2_  = nb2;
+  nmax_ = nb1+nb2+2;
+
+  double *a = grow(arena_, 2*(nb1+2) + 2*(nb2+2) + 5*nmax_);
+  edges1_  = a; a += nb1+2;
+  edges2_  = a; a += nb2+2;
+  cdf1_    = a; a += nb1+2;
+  cdf2_    = a; a += nb2+2;
+  bedgesn_ = a; a += nmax_;
+  dx2_     = a; a += nmax_;
+  x1_      = a; a += nmax_;
+  x2_      = a; a += nmax_;
+  y_       = a;
+
+  // The walk looks one edge past the last one when a curve has reached its
+  // end; that edge continues the curve flat.
+  std::copy(edges1, edges1+nb1+1, edges1_);
+  std::copy(edges2, edges2+nb2+1, edges2_);
+  edges1_[nb1+1] = edges1_[nb1];
+  edges2_[nb2+1] = edges2_[nb2];
+
+  // The union of the edges is the binning of the result
+  nbn_ = morphMergeEdges(edges1_, nb1+1, edges2_, nb2+1, bedgesn_) - 1;
+
+  // ... and at each new edge the width of the hist2 bin it falls in (out of
+  // range edges take the first/last bin, as TAxis::GetBinWidth does)
+  for(int i=0; i<=nbn_; i++) {
+    int bin = std::upper_bound(edges2_, edges2_+nb2+1, bedgesn_[i]) - edges2_;
+    bin = std::min(std::max(bin, 1), nb2);
+    dx2_[i] = (widths2 ? widths2[bin-1] : edges2_[bin]-edges2_[bin-1]);
+  }
+
+  std::fill(y_, y_+nmax_, 0.);
+  npts_ = 0;
+
+  // Treatment for empty histograms: the result is empty
+  double total1 = morphCdf(contents1, nb1, cdf1_);
+  double total2 = morphCdf(contents2, nb2, cdf2_);
+  empty_ = (total1 <= 0 || total2 <= 0);
+  if(empty_) return kMorphEmpty;
+
+  const double *sigdis1 = cdf1_, *sigdis2 = cdf2_;
+  cdf1_[nb1+1] = cdf1_[nb1];
+  cdf2_[nb2+1] = cdf2_[nb2];
+
+  // *
+  // *......We are going to step through all the edges of both input
+  // *      cdf's ordered by increasing value of y. We start at the
+  // *      lower edge, but first we should identify the upper ends of the
+  // *      curves. These (ixl1, ixl2) are the first point in each cdf from
+  // *      above that has the same integral as the last edge.
+  // *
+
+  int ix1l = nb1;
+  int ix2l = nb2;
+  while(sigdis1[ix1l-1] >= sigdis1[ix1l]) {
+    ix1l = ix1l - 1;
+  }
+  while(sigdis2[ix2l-1] >= sigdis2[ix2l]) {
+    ix2l = ix2l - 1;
+  }
+
+  // *
+  // *......Step up to the beginnings of the curves. These (ix1, ix2) are the
+  // *      first non-zero points from below.
+
+  int ix1 = -1;
+  do {
+    ix1 = ix1 + 1;
+  } while(sigdis1[ix1+1] <= sigdis1[0]);
+
+  int ix2 = -1;
+  do {
+    ix2 = ix2 + 1;
+  } while(sigdis2[ix2+1] <= sigdis2[0]);
+
+  //......The first point of the walk. Bin ix+1 has its edges at ix, ix+1.
+
+  double x1 = edges1_[ix1];
+  double x2 = edges2_[ix2];
+  x1_[0] = x1;
+  x2_[0] = x2;
+  y_[0]  = 0;
+  npts_  = 1;
+
+  //......Loop over the remaining point in both curves. Getting the last
+  //      points may be a bit tricky due to limited floating point
+  //      precision.
+
+  double yprev = -1; // The probability y of the previous point
+  double y = 0;
+  while((ix1 < ix1l) | (ix2 < ix2l)) {
+
+    //......Increment to the next lowest point. Step up to the next
+    //      kink in case there are several empty (flat in the integral)
+    //      bins.
+
+    int i12type = -1; // Tells which input distribution we need to
+                      // see next point of.
+    if ((sigdis1[ix1+1] <= sigdis2[ix2+1] || ix2 == ix2l) && ix1 < ix1l) {
+      ix1 = ix1 + 1;
+      while(ix1 < ix1l && sigdis1[ix1+1] <= sigdis1[ix1]) {
+        ix1 = ix1 + 1;
+      }
+      i12type = 1;
+    } else if (ix2 < ix2l) {
+      ix2 = ix2 + 1;
+      while(ix2 < ix2l && sigdis2[ix2+1] <= sigdis2[ix2]) {
+        ix2 = ix2 + 1;
+      }
+      i12type = 2;
+    }
+    if (i12type == 1) {
+      x1 = edges1_[ix1];
+      y = sigdis1[ix1];
+      double x20 = edges2_[ix2];
+      double x21 = edges2_[ix2+1];
+      double y20 = sigdis2[ix2];
+      double y21 = sigdis2[ix2+1];
+
+      //......Calculate where the cummulative probability y in distribution 1
+      //      intersects between the 2 points from distribution 2 which
+      //      bracket it.
+
+      if (y21 > y20) {
+        x2 = x20 + (x21-x20)*(y-y20)/(y21-y20);
+      }
+      else {
+        x2 = x20;
+      }
+    } else {
+      x2 = edges2_[ix2];
+      y = sigdis2[ix2];
+      double x10 = edges1_[ix1];
+      double x11 = edges1_[ix1+1];
+      double y10 = sigdis1[ix1];
+      double y11 = sigdis1[ix1+1];
+
+      //......Calculate where the cummulative probability y in distribution 2
+      //      intersects between the 2 points from distribution 1 which
+      //      brackets it.
+
+      if (y11 > y10) {
+        x1 = x10 + (x11-x10)*(y-y10)/(y11-y10);
+      } else {
+        x1 = x10;
+      }
+    }
+
+    //......Keep the pair (x1,x2) at the cummulative probability y. The
+    //      interpolated edge is wt1*x1+wt2*x2, worked out in morph().
+
+    if (y > yprev) {
+      yprev = y;
+      x1_[npts_] = x1;
+      x2_[npts_] = x2;
+      y_[npts_]  = y;
+      npts_++;
+    }
+  }
+
+  return kMorphOk;
+}
+
+int MorphCore::morph(double wt1, double wt2, double norm, double *out) {
+  return morph(wt1, wt2, norm, out, grow(scratch_, scratchSize()));
+}
+
+int MorphCore::morph(double wt1, double wt2, double norm, double *out, double *scratch) {
+  const int nbn = nbn_;
+  const double *bedgesn = bedgesn_;
+
+  if(empty_) {
+    std::fill(out, out+nbn, 0.);
+    return kMorphEmpty;
+  }
+
+  //......Place the walk at these weights: (xdisn[i],sigdisn[i]) is edge i
+  //      of the interpolated cdf, both are zero beyond the last edge nx3.
+
+  double *xdisn   = scratch;
+  double *sigdisf = scratch + nmax_;
+  const double *sigdisn = y_;
+  const int nx3 = npts_-1;
+  int status = kMorphOk;
+
+  for(int i=0; i<npts_; i++) xdisn[i] = wt1*x1_[i] + wt2*x2_[i];
+  std::fill(xdisn+npts_, xdisn+nmax_, 0.);
+
+  // *......Now we loop over the edges of the bins of the interpolated
+  // *      histogram and find out where the interpolated cdf 3
+  // *      crosses them. This projection defines the result.
+  // *
+  // *......We set all the bins following the final edge to the value
+  // *      of the final edge.
+
+  double x = bedgesn[nbn];
+  double y;
+  int ix = nbn;
+
+  while(x >= xdisn[nx3]) {
+    sigdisf[ix] = sigdisn[nx3];
+    ix = ix-1;
+    if (ix < 0) break; // far extrapolations can move the whole cdf below
+    x = bedgesn[ix];
+  }
+  const int ixl = ix + 1;
+
+  // *
+  // *......The beginning may be empty, so we have to step up to the first
+  // *      edge where the result is nonzero. We zero the bins which have
+  // *      and upper (!) edge which is below the first point of the
+  // *      cummulative distribution we are going to project to this
+  // *      output histogram binning.
+  // *
+
+  ix = 0;
+  x = bedgesn[ix+1];
+  while(x <= xdisn[0]) {
+    sigdisf[ix] = sigdisn[0];
+    ix = ix+1;
+    if (ix >= nbn) break; // ... or above the new binning
+    x = bedgesn[ix+1];
+  }
+  const int ixf = ix;
+
+  // *......Also the end (from y to 1.0) often comes before the last edge
+  // *      so we have to set the following to 1.0 as well.
+
+  int ix3 = 0; // Problems with initial edge!!!
+  for(ix=ixf;ix<ixl;ix++) {
+    x = bedgesn[ix];
+    if (x < xdisn[0]) {
+      y = 0;
+    } else if (x > xdisn[nx3]) {
+      y = 1.;
+    } else {
+      while(xdisn[ix3+1] <= x && ix3 < 2*nbn) {
+        ix3 = ix3 + 1;
+      }
+      if (xdisn[ix3+1]-x > 1.1*dx2_[ix]) { // Empty bin treatment
+        y = sigdisn[ix3+1];
+      }
+      else if (xdisn[ix3+1] > xdisn[ix3]) { // Normal bins
+        y = sigdisn[ix3] + (sigdisn[ix3+1]-sigdisn[ix3])
+          *(x-xdisn[ix3])/(xdisn[ix3+1]-xdisn[ix3]);
+      } else {  // Is this ever used?
+        y = 0;
+        status |= kMorphZeroSlope;
+      }
+    }
+    sigdisf[ix] = y;
+  }
+
+  //......Differentiate the interpolated cdf and renormalise (vectorises).
+
+  for(ix=0; ix<nbn; ix++) out[ix] = (sigdisf[ix+1]-sigdisf[ix])*norm;
+
+  return status;
+}